@@ -1,34 +1,99 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <limits>
 #include <string>
 #include <vector>
 
+#include "GameState.h"
+#include "NamePool.h"
+#include "MoveOrdering.h"
+#include "SearchStats.h"
+#include "Trace.h"
+#include "TranspositionTable.h"
+
 class Node {
 public:
 	std::vector<Node*> children;
-	std::string name;
+	InternedName name;				// pooled, only needed for printing and hashing
 	int value;
 
-	Node(std::string, int, bool dbg = false);	// ctor
+	Node(const std::string&, int, bool dbg = false);	// ctor
 	~Node();						// dtor
-	Node& AddChild(std::string, int);
+	Node& AddChild(const std::string&, int);
 private:
 	bool debug;
-	Node * child;
 };
 
 class AlphaBeta {
 public:
+	virtual ~AlphaBeta() {};
 	virtual int search(Node*, int, int , int, bool) = 0;
-	int searchCount() { return nodeCount; };
-	void clearSearchCount() { nodeCount = 0; };
+	virtual int search(GameState&, int, int, int, bool) = 0;	// children generated on demand
+	long long searchCount() { return nodeCount; };
+	void clearSearchCount() { nodeCount = 0; tableHits = 0; tableMisses = 0; stats.clear(); };
+	long long hitCount() { return tableHits; };
+	long long missCount() { return tableMisses; };
+	const SearchStats& searchStats() { return stats; };		// per ply, since clearSearchCount
+	void setTranspositionTable(TranspositionTable* t) { table = t; };
+	void setMoveOrderer(MoveOrderer* o) { orderer = o; };
+	// Budget for the next searches, 0 is unlimited. An aborted search returns
+	// a meaningless value and must be discarded by the caller.
+	void setSearchLimits(long long maxNodes, long long maxMillis) {
+		nodeLimit = maxNodes;
+		limited = maxNodes > 0 || maxMillis > 0;
+		deadline = maxMillis > 0 ? std::chrono::steady_clock::now() + std::chrono::milliseconds(maxMillis) : std::chrono::steady_clock::time_point::max();
+		aborted = false;
+	};
+	bool searchAborted() { return aborted; };
+	// Aborts the search soon after the flag is set, nullptr detaches it
+	void setStopToken(const std::atomic<bool>* s) { stopToken = s; };
+	SearchTrace& searchTrace() { return trace; };		// cutoff events, when built with ABP_TRACE
+	// Root child the last search chose, an index into the root's children or its
+	// moves in generation order, ties to the first. -1 if no child beat the window.
+	// SimpleAlphaBeta and LazySMP report the start of their variation instead.
+	int bestRootIndex() const { return rootChoice; };
 	const int min = std::numeric_limits<int>::min();			// minimum value
 	const int max = std::numeric_limits<int>::max();
 protected:
-	int nodeCount = 0;
+	long long nodeCount = 0;
+	long long tableHits = 0;
+	long long tableMisses = 0;
+	TranspositionTable* table = nullptr;			// optional, not owned
+	MoveOrderer* orderer = nullptr;					// optional, not owned
+	SearchTrace trace;
+	SearchStats stats;
+	std::atomic<bool> aborted{ false };
+	int rootChoice = -1;
+
+	// Hands this search's budget and stop token to an engine searching for it
+	void shareLimits(AlphaBeta& other) const {
+		other.limited = limited;
+		other.nodeLimit = nodeLimit;
+		other.deadline = deadline;
+		other.stopToken = stopToken;
+		other.aborted = false;
+	};
+
+	bool hasLimits() const { return limited || stopToken != nullptr; };	// a budget or stop token is set
+
+	// Cheap budget check, the stop token and clock are only read every 1024 nodes
+	bool limitReached(long long nodes) {
+		if ((nodes & 1023) == 0 && !aborted) {
+			if (stopToken != nullptr && stopToken->load(std::memory_order_relaxed))
+				aborted = true;
+			else if (limited && ((nodeLimit > 0 && nodes >= nodeLimit) || std::chrono::steady_clock::now() >= deadline))
+				aborted = true;
+		}
+		return aborted;
+	};
 private:
+	bool limited = false;
+	long long nodeLimit = 0;
+	std::chrono::steady_clock::time_point deadline;
+	const std::atomic<bool>* stopToken = nullptr;	// not owned
 	virtual int staticEvaluator() = 0;
 };
 
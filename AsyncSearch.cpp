@@ -0,0 +1,70 @@
+/*************************************************************************************/
+// Asynchronous search class
+/*************************************************************************************/
+#include "AsyncSearch.h"
+
+namespace {
+	DeepeningResult run(IterativeDeepening& driver, Node* root, int maxDepth) {
+		return driver.search(root, maxDepth);
+	}
+
+	DeepeningResult run(IterativeDeepening& driver, const std::shared_ptr<GameState>& state, int maxDepth) {
+		return driver.search(*state, maxDepth);
+	}
+
+	template <class Root>
+	SearchHandle start(AlphaBeta& engine, Root root, int maxDepth, ProgressCallback progress, long long maxMillis, long long maxNodes) {
+		std::shared_ptr<std::atomic<bool>> stop(new std::atomic<bool>(false));
+		std::future<DeepeningResult> result = std::async(std::launch::async,
+			[&engine, root, maxDepth, progress, maxMillis, maxNodes, stop]() {
+				IterativeDeepening driver(engine);
+				driver.setBudget(maxMillis, maxNodes);
+				driver.setStopToken(stop.get());
+				driver.setProgress(progress);
+				return run(driver, root, maxDepth);
+			});
+		return SearchHandle(stop, std::move(result));
+	}
+}
+
+#pragma region SearchHandle
+SearchHandle::SearchHandle(std::shared_ptr<std::atomic<bool>> s, std::future<DeepeningResult> r) : stop(s), result(std::move(r)) {}
+
+SearchHandle& SearchHandle::operator=(SearchHandle&& other) {
+	if (this != &other) {
+		if (result.valid()) {
+			cancel();
+			result.wait();
+		}
+		stop = std::move(other.stop);
+		result = std::move(other.result);
+	}
+	return *this;
+}
+
+SearchHandle::~SearchHandle() {
+	if (result.valid()) {
+		cancel();
+		result.wait();
+	}
+}
+
+bool SearchHandle::waitFor(long long millis) const {
+	return !result.valid() || result.wait_for(std::chrono::milliseconds(millis)) == std::future_status::ready;
+}
+
+DeepeningResult SearchHandle::get() {
+	return result.get();
+}
+#pragma endregion
+
+#pragma region SearchAsync
+SearchHandle SearchAsync(AlphaBeta& engine, const GameState& state, int maxDepth, ProgressCallback progress, long long maxMillis, long long maxNodes) {
+	std::shared_ptr<GameState> copy(state.clone());
+	return start(engine, copy, maxDepth, progress, maxMillis, maxNodes);
+}
+
+SearchHandle SearchAsync(AlphaBeta& engine, Node* root, int maxDepth, ProgressCallback progress, long long maxMillis, long long maxNodes) {
+	return start(engine, root, maxDepth, progress, maxMillis, maxNodes);
+}
+#pragma endregion
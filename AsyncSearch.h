@@ -0,0 +1,38 @@
+#pragma once
+/*************************************************************************************/
+// Asynchronous search class header
+// Runs an iterative deepening search on its own thread and returns at once with a
+// handle. cancel() sets a stop token the engine reads every 1024 nodes, the handle
+// then yields the deepest iteration that completed. Progress is reported on the
+// search thread after every iteration. The engine belongs to the search until it
+// finishes, a GameState is cloned, a Node tree must outlive the search.
+/*************************************************************************************/
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "AlphaBeta.h"
+#include "GameState.h"
+#include "IterativeDeepening.h"
+
+typedef std::function<void(const DeepeningResult&)> ProgressCallback;
+
+class SearchHandle {
+public:
+	SearchHandle(std::shared_ptr<std::atomic<bool>>, std::future<DeepeningResult>);
+	SearchHandle(SearchHandle&&) = default;
+	SearchHandle& operator=(SearchHandle&&);	// cancels the search it replaces
+	~SearchHandle();							// an abandoned search is cancelled
+
+	void cancel() { stop->store(true); };
+	bool waitFor(long long millis) const;		// true once the search has finished
+	DeepeningResult get();						// blocks, only once
+private:
+	std::shared_ptr<std::atomic<bool>> stop;
+	std::future<DeepeningResult> result;
+};
+
+SearchHandle SearchAsync(AlphaBeta&, const GameState&, int maxDepth, ProgressCallback progress = nullptr, long long maxMillis = 0, long long maxNodes = 0);
+SearchHandle SearchAsync(AlphaBeta&, Node*, int maxDepth, ProgressCallback progress = nullptr, long long maxMillis = 0, long long maxNodes = 0);
@@ -0,0 +1,54 @@
+/*************************************************************************************/
+// Batched search class
+/*************************************************************************************/
+#include "BatchSearch.h"
+
+#pragma region BatchSearch
+BatchSearch::BatchSearch(ThreadPool& p, EngineFactory f) : pool(p), factory(f) {}
+
+// One task per query, the calling thread helps until all are done. An exception
+// must not leave a worker thread, the engine that threw is dropped.
+std::vector<QueryResult> BatchSearch::search(const std::vector<SearchQuery>& queries) {
+	std::vector<QueryResult> results(queries.size());
+	TaskGroup group;
+
+	for (size_t i = 0; i < queries.size(); i++) {
+		pool.run(group, [this, &queries, &results, i]() {
+			const SearchQuery& q = queries[i];
+			try {
+				std::unique_ptr<AlphaBeta> engine = acquire();
+				engine->clearSearchCount();
+				if (q.state != nullptr)
+					results[i].value = engine->search(*q.state, q.depth, q.alpha, q.beta, q.isMax);
+				else if (q.root != nullptr)
+					results[i].value = engine->search(q.root, q.depth, q.alpha, q.beta, q.isMax);
+				results[i].nodes = engine->searchCount();
+				release(std::move(engine));
+			}
+			catch (...) {
+				results[i] = QueryResult();
+				results[i].error = std::current_exception();
+			}
+		});
+	}
+	pool.wait(group);
+	return results;
+}
+
+std::unique_ptr<AlphaBeta> BatchSearch::acquire() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (!idle.empty()) {
+			std::unique_ptr<AlphaBeta> engine = std::move(idle.back());
+			idle.pop_back();
+			return engine;
+		}
+	}
+	return factory();
+}
+
+void BatchSearch::release(std::unique_ptr<AlphaBeta> engine) {
+	std::lock_guard<std::mutex> guard(lock);
+	idle.push_back(std::move(engine));
+}
+#pragma endregion
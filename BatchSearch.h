@@ -0,0 +1,49 @@
+#pragma once
+/*************************************************************************************/
+// Batched search class header
+// Searches many independent roots or positions concurrently on a shared thread
+// pool. Engines come from a factory and are reused between queries; results and
+// node counts are returned in query order. A query owns its root: two queries
+// must not share a tree or a GameState object, engines may write to them. A
+// query that throws reports the exception in its result, the others still run.
+/*************************************************************************************/
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AlphaBeta.h"
+#include "GameState.h"
+#include "ThreadPool.h"
+
+struct SearchQuery {
+	Node* root = nullptr;					// either a tree root
+	GameState* state = nullptr;				// or a position
+	int depth = 0;
+	int alpha = std::numeric_limits<int>::min();
+	int beta = std::numeric_limits<int>::max();
+	bool isMax = true;
+};
+
+struct QueryResult {
+	int value = 0;
+	long long nodes = 0;
+	std::exception_ptr error;				// set if the search threw, value and nodes are then 0
+};
+
+class BatchSearch {
+public:
+	typedef std::function<std::unique_ptr<AlphaBeta>()> EngineFactory;
+
+	BatchSearch(ThreadPool&, EngineFactory);
+	std::vector<QueryResult> search(const std::vector<SearchQuery>&);
+private:
+	ThreadPool& pool;
+	EngineFactory factory;
+	std::mutex lock;
+	std::vector<std::unique_ptr<AlphaBeta>> idle;		// engines not in use
+
+	std::unique_ptr<AlphaBeta> acquire();
+	void release(std::unique_ptr<AlphaBeta>);
+};
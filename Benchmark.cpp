@@ -0,0 +1,164 @@
+/**************************************************************/
+// Alpha Beta Pruning benchmark
+// Generates seeded uniform trees and runs every engine over them,
+// one JSON object per line on stdout:
+//   Benchmark -b <branching> -d <depth> [-order random|best|worst|all]
+//             [-seed <n>] [-threads <n>] [-repeat <n>] [-save <file>] [-stats 1]
+// -save writes each generated tree as a tree file, the ordering name is appended
+// -stats 1 follows every search with its per ply counters
+// With -repeat above 1 each search ends with p50/p99/max lines per engine and ordering
+/**************************************************************/
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Local includes
+#include "AlphaBeta.h"
+#include "FlatTree.h"
+#include "FlatTreeState.h"
+#include "LazySMP.h"
+#include "ParallelAlphaBeta.h"
+#include "PhaseTimer.h"
+#include "PVSAlphaBeta.h"
+#include "SearchCore.h"
+#include "SimpleAlphaBeta.h"
+#include "TreeFile.h"
+#include "TreeGenerator.h"
+
+// Forward Class / Function definitions
+long long peakMemoryKB();
+void report(const std::string&, TreeOrdering, unsigned int, unsigned int, unsigned int, const std::string&, int, long long, double);
+
+// Main program
+int main(int argc, char* argv[]) {
+	unsigned int branching = 8;
+	unsigned int depth = 6;
+	unsigned int seed = 1;
+	unsigned int threads = std::thread::hardware_concurrency();
+	int repeat = 1;
+	std::string saveFile;
+	bool statistics = false;
+	PhaseTimer phases;
+	std::vector<TreeOrdering> orderings = { TreeOrdering::Random, TreeOrdering::Best, TreeOrdering::Worst };
+	int min = std::numeric_limits<int>::min();
+	int max = std::numeric_limits<int>::max();
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string option = argv[i];
+		std::string value = argv[i + 1];
+		if (option == "-b")
+			branching = (unsigned int)std::stoul(value);
+		else if (option == "-d")
+			depth = (unsigned int)std::stoul(value);
+		else if (option == "-seed")
+			seed = (unsigned int)std::stoul(value);
+		else if (option == "-threads")
+			threads = (unsigned int)std::stoul(value);
+		else if (option == "-repeat")
+			repeat = std::stoi(value);
+		else if (option == "-save")
+			saveFile = value;
+		else if (option == "-stats")
+			statistics = value != "0";
+		else if (option == "-order" && value != "all")
+			orderings = { value == "best" ? TreeOrdering::Best : (value == "worst" ? TreeOrdering::Worst : TreeOrdering::Random) };
+	}
+
+	for (TreeOrdering ordering : orderings) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		FlatTree tree = GenerateUniformTree(branching, depth, ordering, seed);
+		double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		report("build", ordering, branching, depth, seed, "generator", 0, tree.size(), buildSeconds);
+		if (!saveFile.empty()) {
+			start = std::chrono::steady_clock::now();
+			WriteTreeFile(saveFile + "." + OrderingName(ordering), tree, false);
+			double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			report("save", ordering, branching, depth, seed, "writer", 0, tree.size(), saveSeconds);
+		}
+
+		for (int r = 0; r < repeat; r++) {
+			// Native flat search
+			{
+				SimpleAlphaBeta engine;
+				start = std::chrono::steady_clock::now();
+				int value = engine.search(tree, 0, depth, min, max, true);
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				report("search", ordering, branching, depth, seed, "simple-flat", value, engine.searchCount(), seconds);
+				phases.Record("search:simple-flat:" + OrderingName(ordering), (unsigned long long)(seconds * 1e9));
+				if (statistics)
+					engine.searchStats().writeJson(std::cout, "simple-flat");
+			}
+			{
+				TemplateAlphaBeta<> engine;
+				start = std::chrono::steady_clock::now();
+				int value = engine.search(tree, 0, depth, min, max, true);
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				report("search", ordering, branching, depth, seed, "template-flat", value, engine.searchCount(), seconds);
+				phases.Record("search:template-flat:" + OrderingName(ordering), (unsigned long long)(seconds * 1e9));
+				if (statistics)
+					engine.searchStats().writeJson(std::cout, "template-flat");
+			}
+
+			// Every engine through the GameState interface
+			std::vector<std::pair<std::string, std::unique_ptr<AlphaBeta>>> engines;
+			engines.emplace_back("simple", std::unique_ptr<AlphaBeta>(new SimpleAlphaBeta()));
+			engines.emplace_back("pvs", std::unique_ptr<AlphaBeta>(new PVSAlphaBeta()));
+			engines.emplace_back("template", std::unique_ptr<AlphaBeta>(new TemplateAlphaBeta<>()));
+			engines.emplace_back("parallel", std::unique_ptr<AlphaBeta>(new ParallelAlphaBeta(threads)));
+			engines.emplace_back("lazysmp", std::unique_ptr<AlphaBeta>(new LazySMPAlphaBeta(threads)));
+			for (auto& e : engines) {
+				FlatTreeState state(tree);
+				start = std::chrono::steady_clock::now();
+				int value = e.second->search(state, depth, min, max, true);
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				report("search", ordering, branching, depth, seed, e.first, value, e.second->searchCount(), seconds);
+				phases.Record("search:" + e.first + ":" + OrderingName(ordering), (unsigned long long)(seconds * 1e9));
+				if (statistics)
+					e.second->searchStats().writeJson(std::cout, e.first);
+			}
+		}
+	}
+	if (repeat > 1)
+		phases.WriteJson(std::cout);
+	return 0;
+}
+
+#pragma region Report
+void report(const std::string& phase, TreeOrdering ordering, unsigned int branching, unsigned int depth, unsigned int seed,
+	const std::string& engine, int value, long long nodes, double seconds) {
+	// Effective branching factor: the b with b^depth equal to the nodes searched
+	double ebf = depth > 0 && nodes > 0 ? std::pow((double)nodes, 1.0 / depth) : 0.0;
+
+	std::cout << "{\"phase\":\"" << phase << "\",\"tree\":\"uniform\",\"ordering\":\"" << OrderingName(ordering)
+		<< "\",\"branching\":" << branching << ",\"depth\":" << depth << ",\"seed\":" << seed
+		<< ",\"engine\":\"" << engine << "\",\"value\":" << value << ",\"nodes\":" << nodes
+		<< ",\"seconds\":" << seconds << ",\"nodes_per_sec\":" << (seconds > 0 ? (long long)(nodes / seconds) : 0)
+		<< ",\"ebf\":" << ebf << ",\"peak_memory_kb\":" << peakMemoryKB() << "}" << std::endl;
+}
+
+long long peakMemoryKB() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return (long long)(counters.PeakWorkingSetSize / 1024);
+	return 0;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#endif
+}
+#pragma endregion
@@ -0,0 +1,498 @@
+/*************************************************************************************/
+// Distributed root search class
+/*************************************************************************************/
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "DistributedSearch.h"
+#include "SimpleAlphaBeta.h"
+#include "TreeParser.h"
+
+#ifndef _WIN32
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+	// unix:/path or host:port, listening or connected
+	int openSocket(const std::string& address, bool listening) {
+		if (address.compare(0, 5, "unix:") == 0) {
+			std::string path = address.substr(5);
+			struct sockaddr_un addr;
+			std::memset(&addr, 0, sizeof(addr));
+			addr.sun_family = AF_UNIX;
+			if (path.empty() || path.size() >= sizeof(addr.sun_path))
+				throw std::runtime_error("Bad socket path " + address);
+			std::strcpy(addr.sun_path, path.c_str());
+			int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd >= 0 && listening) {
+				unlink(path.c_str());
+				if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0 && listen(fd, 8) == 0)
+					return fd;
+			}
+			else if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+				return fd;
+			}
+			std::string reason = std::strerror(errno);
+			if (fd >= 0)
+				close(fd);
+			throw std::runtime_error("Cannot " + std::string(listening ? "listen on " : "connect to ") + address + ": " + reason);
+		}
+
+		size_t colon = address.rfind(':');
+		struct addrinfo hints;
+		struct addrinfo* found = nullptr;
+		std::memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = listening ? AI_PASSIVE : 0;
+		if (colon == std::string::npos || getaddrinfo(colon > 0 ? address.substr(0, colon).c_str() : nullptr, address.substr(colon + 1).c_str(), &hints, &found) != 0)
+			throw std::runtime_error("Bad address " + address + ", expected unix:/path or host:port");
+		std::string reason = "no address";
+		for (struct addrinfo* a = found; a != nullptr; a = a->ai_next) {
+			int fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+			int on = 1;
+			if (fd < 0)
+				continue;
+			if (listening) {
+				setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+				if (bind(fd, a->ai_addr, a->ai_addrlen) == 0 && listen(fd, 8) == 0) {
+					freeaddrinfo(found);
+					return fd;
+				}
+			}
+			else if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));	// messages are small
+				freeaddrinfo(found);
+				return fd;
+			}
+			reason = std::strerror(errno);
+			close(fd);
+		}
+		freeaddrinfo(found);
+		throw std::runtime_error("Cannot " + std::string(listening ? "listen on " : "connect to ") + address + ": " + reason);
+	}
+
+	// One unit at a time, searched on its own thread so CANCEL and BOUND are
+	// read while it runs. The table lives as long as the connection.
+	class WorkerSession {
+	public:
+		explicit WorkerSession(Channel& c) : channel(c), table(18) {
+			engine.setTranspositionTable(&table);
+			engine.setStopToken(&stop);
+		};
+		~WorkerSession() {
+			stop = true;
+			finish();
+		};
+		void serve();
+	private:
+		Channel& channel;
+		SimpleAlphaBeta engine;
+		TranspositionTable table;
+		std::thread job;
+		std::atomic<bool> stop{ false };
+		std::atomic<long long> current{ -1 };
+		std::atomic<int> alpha{ 0 };
+		std::atomic<int> beta{ 0 };
+
+		void finish() {
+			if (job.joinable())
+				job.join();
+		};
+		void run(long long, int, bool, const std::string&, const std::string&);
+	};
+
+	void WorkerSession::serve() {
+		std::string line;
+
+		while (channel.readLine(line)) {
+			std::istringstream in(line);
+			std::string verb;
+			long long id = -1;
+			in >> verb >> id;
+			if (verb == "SEARCH") {
+				int depth = 0;
+				int a = 0;
+				int b = 0;
+				int isMax = 0;
+				size_t bytes = 0;
+				std::string kind;
+				std::string payload;
+				in >> depth >> a >> b >> isMax >> kind >> bytes;
+				if (!in || !channel.readBytes(bytes, payload))
+					break;
+				finish();
+				stop = false;
+				alpha = a;
+				beta = b;
+				current = id;
+				job = std::thread(&WorkerSession::run, this, id, depth, isMax != 0, kind, payload);
+			}
+			else if (verb == "BOUND" && id == current) {
+				int a = 0;
+				int b = 0;
+				if (in >> a >> b) {
+					alpha = a;
+					beta = b;
+				}
+			}
+			else if (verb == "CANCEL" && id == current) {
+				stop = true;
+			}
+			else if (verb == "QUIT") {
+				break;
+			}
+		}
+	}
+
+	// Deepens to the unit depth, each iteration takes the latest window
+	void WorkerSession::run(long long id, int depth, bool isMax, const std::string& kind, const std::string& payload) {
+		std::unique_ptr<Node> root;
+		std::unique_ptr<NimState> state;
+		int value = 0;
+		int usedAlpha = alpha;
+		int usedBeta = beta;
+
+		try {
+			if (kind == "tree") {
+				std::istringstream in(payload);
+				TreeParser parser;
+				root.reset(parser.Parse(in, "unit " + std::to_string(id)));
+			}
+			else {
+				state.reset(new NimState(payload, kind == "misere", isMax));
+			}
+		}
+		catch (const std::exception& e) {
+			channel.send("ERROR " + std::to_string(id) + " " + e.what() + "\n");
+			return;
+		}
+		engine.clearSearchCount();
+		engine.setSearchLimits(0, 0);
+		for (int d = depth > 0 ? 1 : 0; d <= depth; d++) {
+			int a = alpha;
+			int b = beta;
+			int v = root != nullptr ? engine.search(root.get(), d, a, b, isMax) : engine.search(*state, d, a, b, isMax);
+			if (engine.searchAborted())
+				break;
+			value = v;
+			usedAlpha = a;
+			usedBeta = b;
+			channel.send("DEPTH " + std::to_string(id) + " " + std::to_string(d) + " " + std::to_string(v) + " " + std::to_string(engine.searchCount()) + "\n");
+		}
+		channel.send("RESULT " + std::to_string(id) + " " + std::to_string(value) + " " + std::to_string(engine.searchCount()) + " " + (engine.searchAborted() ? "1" : "0")
+			+ " " + std::to_string(usedAlpha) + " " + std::to_string(usedBeta) + "\n");
+	}
+}
+#endif
+
+#pragma region Channel
+Channel::Channel(int f) : fd(f) {}
+
+Channel::~Channel() {
+#ifndef _WIN32
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+bool Channel::send(const std::string& data) {
+#ifndef _WIN32
+	std::lock_guard<std::mutex> guard(writeLock);
+	size_t sent = 0;
+
+	while (sent < data.size()) {
+		ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		sent += (size_t)n;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Channel::fill() {
+#ifndef _WIN32
+	char chunk[4096];
+	ssize_t n;
+
+	do {
+		n = recv(fd, chunk, sizeof(chunk), 0);
+	} while (n < 0 && errno == EINTR);
+	if (n <= 0)
+		return false;
+	buffer.append(chunk, (size_t)n);
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Channel::nextLine(std::string& line) {
+	size_t end = buffer.find('\n');
+
+	if (end == std::string::npos)
+		return false;
+	line = buffer.substr(0, end);
+	buffer.erase(0, end + 1);
+	return true;
+}
+
+bool Channel::readLine(std::string& line) {
+	while (!nextLine(line)) {
+		if (!fill())
+			return false;
+	}
+	return true;
+}
+
+bool Channel::readBytes(size_t count, std::string& data) {
+	while (buffer.size() < count) {
+		if (!fill())
+			return false;
+	}
+	data = buffer.substr(0, count);
+	buffer.erase(0, count);
+	return true;
+}
+#pragma endregion
+
+#pragma region DistributedSearch
+DistributedSearch::~DistributedSearch() {
+	for (std::unique_ptr<Channel>& w : workers)
+		w->send("QUIT\n");
+	workers.clear();
+#ifndef _WIN32
+	for (int pid : children)
+		waitpid(pid, nullptr, 0);
+#endif
+}
+
+void DistributedSearch::connect(const std::string& address) {
+#ifndef _WIN32
+	workers.emplace_back(new Channel(openSocket(address, false)));
+#else
+	throw std::runtime_error("Distributed search needs POSIX sockets, cannot connect to " + address);
+#endif
+}
+
+// The child gets its end of the pair as fd:<n>, the parent ends are closed on exec
+void DistributedSearch::spawn(unsigned int count, const std::string& program) {
+#ifndef _WIN32
+	for (unsigned int i = 0; i < count; i++) {
+		int pair[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+			throw std::runtime_error(std::string("Cannot create worker socket: ") + std::strerror(errno));
+		fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+		std::string address = "fd:" + std::to_string(pair[1]);
+		int pid = fork();
+		if (pid == 0) {
+			execl(program.c_str(), program.c_str(), "-worker", address.c_str(), (char*)nullptr);
+			_exit(127);
+		}
+		close(pair[1]);
+		if (pid < 0) {
+			close(pair[0]);
+			throw std::runtime_error(std::string("Cannot start worker: ") + std::strerror(errno));
+		}
+		workers.emplace_back(new Channel(pair[0]));
+		children.push_back(pid);
+	}
+#else
+	(void)count;
+	throw std::runtime_error("Distributed search needs POSIX sockets, cannot start " + program);
+#endif
+}
+
+// Units go out in order with the current root window. A result raising the
+// root bound narrows the window of the units still running, a root cutoff
+// cancels them. Every unit handed out is waited for, so no stale message is
+// left for the next search.
+DistributedResult DistributedSearch::search(const std::vector<WorkUnit>& units, int depth, int alpha, int beta, bool isMax) {
+	DistributedResult result;
+#ifndef _WIN32
+	std::vector<int> busy(workers.size(), -1);		// unit index per worker
+	long long base = nextId;
+	size_t next = 0;
+
+	if (workers.empty())
+		throw std::runtime_error("Distributed search without workers");
+	nextId += (long long)units.size();
+	result.value = isMax ? alpha : beta;
+	while (true) {
+		for (size_t w = 0; w < workers.size() && next < units.size(); w++) {
+			if (busy[w] >= 0)
+				continue;
+			std::ostringstream header;
+			header << "SEARCH " << base + (long long)next << " " << depth - 1 << " " << (isMax ? result.value : alpha) << " "
+				<< (isMax ? beta : result.value) << " " << (isMax ? 0 : 1) << " " << units[next].kind << " " << units[next].payload.size() << "\n";
+			if (!workers[w]->send(header.str() + units[next].payload))
+				throw std::runtime_error("Worker " + std::to_string(w) + " disconnected");
+			busy[w] = (int)next++;
+		}
+
+		std::vector<struct pollfd> fds;
+		std::vector<size_t> owner;
+		for (size_t w = 0; w < workers.size(); w++) {
+			if (busy[w] >= 0) {
+				struct pollfd p = { workers[w]->handle(), POLLIN, 0 };
+				fds.push_back(p);
+				owner.push_back(w);
+			}
+		}
+		if (fds.empty())
+			break;
+		if (poll(fds.data(), fds.size(), -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			throw std::runtime_error(std::string("Worker poll failed: ") + std::strerror(errno));
+		}
+
+		for (size_t i = 0; i < fds.size(); i++) {
+			size_t w = owner[i];
+			std::string line;
+			if (fds[i].revents == 0)
+				continue;
+			if (!workers[w]->fill())
+				throw std::runtime_error("Worker " + std::to_string(w) + " disconnected");
+			while (busy[w] >= 0 && workers[w]->nextLine(line)) {
+				std::istringstream in(line);
+				std::string verb;
+				long long id = -1;
+				in >> verb >> id;
+				if (verb == "ERROR")
+					throw std::runtime_error("Worker " + std::to_string(w) + ": " + line);
+				if (verb != "RESULT" || id != base + busy[w])
+					continue;					// progress, or a unit of an earlier search
+
+				int unit = busy[w];
+				int value = 0;
+				long long nodes = 0;
+				int cancelled = 0;
+				int usedAlpha = 0;
+				int usedBeta = 0;
+				in >> value >> nodes >> cancelled >> usedAlpha >> usedBeta;
+				busy[w] = -1;
+				result.nodes += nodes;
+				if (cancelled != 0) {
+					result.cancelled++;
+					continue;
+				}
+				result.completed++;
+				// Ties go to the lower child, as in a serial search, when the value is exact.
+				// A value on the window the worker last searched with, raised by BOUND
+				// or not, is only a fail-hard bound.
+				bool better = isMax ? value > result.value : value < result.value;
+				bool exactTie = value == result.value && unit < result.bestIndex && usedAlpha < value && value < usedBeta;
+				if (result.bestIndex < 0 || better || exactTie) {
+					result.bestIndex = unit;
+					if (better)
+						result.value = value;
+				}
+				if (!better)
+					continue;
+				if (isMax ? result.value >= beta : result.value <= alpha) {
+					result.cancelled += (unsigned int)(units.size() - next);
+					next = units.size();
+					for (size_t o = 0; o < workers.size(); o++) {
+						if (busy[o] >= 0)
+							workers[o]->send("CANCEL " + std::to_string(base + busy[o]) + "\n");
+					}
+				}
+				else {
+					// Lower children keep one more value open, so an equal one of them is
+					// proven exact and wins the tie
+					for (size_t o = 0; o < workers.size(); o++) {
+						if (busy[o] < 0)
+							continue;
+						int bound = busy[o] < result.bestIndex ? (isMax ? result.value - 1 : result.value + 1) : result.value;
+						workers[o]->send("BOUND " + std::to_string(base + busy[o]) + " " + std::to_string(isMax ? bound : alpha) + " "
+							+ std::to_string(isMax ? beta : bound) + "\n");
+					}
+				}
+			}
+		}
+	}
+#else
+	(void)units; (void)depth; (void)alpha; (void)beta; (void)isMax;
+	throw std::runtime_error("Distributed search needs POSIX sockets");
+#endif
+	return result;
+}
+
+std::vector<WorkUnit> DistributedSearch::splitRoot(const Node* root) {
+	std::vector<WorkUnit> units;
+
+	for (const Node* child : root->children) {
+		std::ostringstream out;
+		WriteTextTree(out, child);
+		units.push_back({ "tree", out.str() });
+	}
+	return units;
+}
+
+std::vector<WorkUnit> DistributedSearch::splitRoot(NimState& state, bool misere) {
+	std::vector<WorkUnit> units;
+	std::vector<Move> moves;
+
+	state.generateMoves(moves);
+	for (Move m : moves) {
+		state.apply(m);
+		units.push_back({ misere ? "misere" : "nim", state.name() });
+		state.undo(m);
+	}
+	return units;
+}
+#pragma endregion
+
+#pragma region Worker
+int RunWorker(const std::string& address) {
+#ifndef _WIN32
+	if (address.compare(0, 3, "fd:") == 0) {
+		Channel channel(std::stoi(address.substr(3)));
+		WorkerSession session(channel);
+		session.serve();
+		return 0;
+	}
+	int listener = openSocket(address, true);
+	std::cout << "Worker listening on " << address << std::endl;
+	while (true) {
+		int fd = accept(listener, nullptr, nullptr);
+		if (fd < 0 && errno == EINTR)
+			continue;
+		if (fd < 0)
+			break;
+		Channel channel(fd);
+		WorkerSession session(channel);
+		session.serve();
+	}
+	std::cerr << "Error: accept failed on " << address << ": " << std::strerror(errno) << std::endl;
+	close(listener);
+	return 1;
+#else
+	std::cerr << "Error: distributed search needs POSIX sockets, cannot serve " << address << std::endl;
+	return 1;
+#endif
+}
+#pragma endregion
@@ -0,0 +1,79 @@
+#pragma once
+/*************************************************************************************/
+// Distributed root search class header
+// A coordinator splits the root into one work unit per child and hands them out
+// to worker processes over Unix domain or TCP sockets, one unit per worker at a
+// time. Workers deepen iteratively with the serial engine and stream a line after
+// every completed depth, then the result. When a child raises the root bound the
+// coordinator sends the new window to busy workers, picked up at their next
+// depth. A root cutoff cancels every unit still running or queued.
+// Protocol, one text line per message, SEARCH is followed by its payload:
+//   SEARCH <id> <depth> <alpha> <beta> <isMax> <tree|nim|misere> <bytes>
+//   BOUND <id> <alpha> <beta>, CANCEL <id>, QUIT
+//   DEPTH <id> <depth> <value> <nodes>, RESULT <id> <value> <nodes> <cancelled> <alpha> <beta>,
+//   ERROR <id> <message>
+// RESULT carries the window of the last completed depth, the value is exact only
+// strictly inside it. A tree unit is the child subtree in text tree form, a Nim
+// unit the position.
+// POSIX only, elsewhere every call throws.
+/*************************************************************************************/
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AlphaBeta.h"
+#include "NimState.h"
+
+struct WorkUnit {
+	std::string kind;						// tree, nim or misere
+	std::string payload;
+};
+
+struct DistributedResult {
+	int value = 0;
+	int bestIndex = -1;						// root child index, -1 if nothing completed
+	long long nodes = 0;					// summed over the workers
+	unsigned int completed = 0;
+	unsigned int cancelled = 0;				// cut off at the root, running or queued
+};
+
+// Buffered socket, writes may come from any thread
+class Channel {
+public:
+	explicit Channel(int);
+	~Channel();
+	Channel(const Channel&) = delete;
+	Channel& operator=(const Channel&) = delete;
+	int handle() const { return fd; };
+	bool send(const std::string&);
+	bool readLine(std::string&);				// blocks, false at end of stream
+	bool readBytes(size_t, std::string&);
+	bool fill();								// one read into the buffer, false at end of stream
+	bool nextLine(std::string&);				// a complete buffered line, never blocks
+private:
+	int fd;
+	std::string buffer;
+	std::mutex writeLock;
+};
+
+class DistributedSearch {
+public:
+	~DistributedSearch();						// workers are told to quit, local ones reaped
+	void connect(const std::string&);			// unix:/path or host:port of a listening worker
+	void spawn(unsigned int, const std::string&);	// local worker processes of this program on socket pairs
+	unsigned int workerCount() const { return (unsigned int)workers.size(); };
+	DistributedResult search(const std::vector<WorkUnit>&, int, int, int, bool);
+
+	static std::vector<WorkUnit> splitRoot(const Node*);
+	static std::vector<WorkUnit> splitRoot(NimState&, bool);	// position, misere
+private:
+	std::vector<std::unique_ptr<Channel>> workers;
+	std::vector<int> children;					// process ids of spawned workers
+	long long nextId = 0;						// unit ids are never reused, late messages are recognised
+};
+
+// Serves coordinators until killed: unix:/path or host:port to listen on, fd:<n>
+// for a socket inherited from the coordinator, served once
+int RunWorker(const std::string&);
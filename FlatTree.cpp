@@ -0,0 +1,105 @@
+/*************************************************************************************/
+// Flat tree class
+/*************************************************************************************/
+#include <deque>
+#include <utility>
+
+#include "AlphaBeta.h"
+#include "FlatTree.h"
+
+#pragma region FlatTree
+FlatTree::FlatTree() {}
+
+// Flatten a Node tree in breadth first order, a node keeps its value when it is cut
+FlatTree::FlatTree(const Node* root, int maxPly) {
+	std::deque<std::pair<const Node*, unsigned int>> queue;
+	unsigned int first = 0;
+	unsigned int plyEnd = 1;					// index after the last node of the current ply
+	int ply = 0;
+
+	if (root == nullptr)
+		return;
+	queue.push_back({ root, AddRoot(root->name, root->value) });
+	while (!queue.empty()) {
+		const Node* n = queue.front().first;
+		unsigned int index = queue.front().second;
+		queue.pop_front();
+
+		if (index == plyEnd) {
+			ply++;
+			plyEnd = size();
+		}
+		if (n->children.size() > 0 && ply != maxPly) {
+			first = AddChildren(index, (unsigned int)n->children.size());
+			for (unsigned int i = 0; i < n->children.size(); i++) {
+				SetNode(first + i, n->children[i]->name, n->children[i]->value);
+				queue.push_back({ n->children[i], first + i });
+			}
+		}
+	}
+	Finish();
+}
+
+unsigned int FlatTree::AddRoot(const std::string& n, int v) {
+	clear();
+	AddChildren(0, 1);
+	childCount[0] = 0;
+	SetNode(0, n, v);
+	return 0;
+}
+
+// Append count empty nodes and make them the children of parent
+unsigned int FlatTree::AddChildren(unsigned int parent, unsigned int count) {
+	unsigned int first = size();
+
+	values.resize(first + count, 0);
+	firstChild.resize(first + count, 0);
+	childCount.resize(first + count, 0);
+	if (parent < first) {
+		firstChild[parent] = first;
+		childCount[parent] = count;
+	}
+	return first;
+}
+
+// Offset 0 holds an empty name, nodes never named point there
+void FlatTree::SetNode(unsigned int index, const std::string& n, int v) {
+	values[index] = v;
+	if (nameData.empty())
+		nameData.push_back('\0');
+	if (nameOffset.size() < size())
+		nameOffset.resize(size(), 0);
+	auto found = nameIndex.find(n);
+	if (found == nameIndex.end()) {
+		found = nameIndex.emplace(n, (unsigned int)nameData.size()).first;
+		nameData.append(n);
+		nameData.push_back('\0');
+	}
+	nameOffset[index] = found->second;
+}
+
+std::string FlatTree::Name(unsigned int index) const {
+	return std::string(NameData(index));
+}
+
+void FlatTree::reserve(unsigned int count) {
+	values.reserve(count);
+	firstChild.reserve(count);
+	childCount.reserve(count);
+}
+
+// Names set after this are still found, but no longer shared with earlier ones
+void FlatTree::Finish() {
+	std::unordered_map<std::string, unsigned int>().swap(nameIndex);
+}
+
+// Release every node at once
+void FlatTree::clear() {
+	std::vector<int>().swap(values);
+	std::vector<unsigned int>().swap(firstChild);
+	std::vector<unsigned int>().swap(childCount);
+	std::vector<unsigned int>().swap(nameOffset);
+	std::string().swap(nameData);
+	Finish();
+}
+#pragma endregion
@@ -0,0 +1,40 @@
+#pragma once
+/*************************************************************************************/
+// Flat tree class header
+// Nodes are stored breadth first in structure-of-arrays form, so the children of
+// a node are contiguous and a search walks indexes instead of chasing pointers.
+// Names live in a side table and are only needed when printing, generated trees
+// may leave every node unnamed. A repeated name is stored once.
+/*************************************************************************************/
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Node;
+
+class FlatTree {
+public:
+	std::vector<int> values;
+	std::vector<unsigned int> firstChild;
+	std::vector<unsigned int> childCount;
+
+	FlatTree();
+	// Flatten a Node tree, nodes maxPly below the root become leaves, -1 is no limit
+	explicit FlatTree(const Node*, int maxPly = -1);
+	unsigned int AddRoot(const std::string&, int);
+	unsigned int AddChildren(unsigned int, unsigned int);	// reserve a contiguous child block
+	void SetNode(unsigned int, const std::string&, int);
+	void SetValue(unsigned int index, int v) { values[index] = v; };	// leaves the node unnamed
+	std::string Name(unsigned int) const;
+	const char* NameData(unsigned int index) const { return index < nameOffset.size() ? nameData.c_str() + nameOffset[index] : ""; };
+	unsigned int size() const { return (unsigned int)values.size(); };
+	const std::vector<unsigned int>& NameOffsets() const { return nameOffset; };
+	const std::string& NameTable() const { return nameData; };
+	void reserve(unsigned int);
+	void Finish();								// built, drops the name index
+	void clear();								// bulk free
+private:
+	std::vector<unsigned int> nameOffset;		// offset into nameData
+	std::string nameData;						// '\0' separated names
+	std::unordered_map<std::string, unsigned int> nameIndex;	// name to offset, until Finish
+};
@@ -0,0 +1,55 @@
+/*************************************************************************************/
+// Flat tree game state class
+/*************************************************************************************/
+#include "FlatTreeState.h"
+
+#pragma region FlatTreeState
+FlatTreeState::FlatTreeState(const FlatTree& t, unsigned int root, bool max) : tree(t), maxToMove(max) {
+	path.push_back(root);
+}
+
+void FlatTreeState::generateMoves(std::vector<Move>& moves) const {
+	unsigned int first = tree.firstChild[current()];
+
+	moves.clear();
+	for (unsigned int c = first; c < first + tree.childCount[current()]; c++)
+		moves.push_back((Move)c);
+}
+
+void FlatTreeState::apply(Move m) {
+	path.push_back((unsigned int)m);
+	maxToMove = !maxToMove;
+}
+
+void FlatTreeState::undo(Move) {
+	path.pop_back();
+	maxToMove = !maxToMove;
+}
+
+bool FlatTreeState::isTerminal() const {
+	return tree.childCount[current()] == 0;
+}
+
+int FlatTreeState::evaluate() const {
+	return tree.values[current()];
+}
+
+// Every node is a distinct position, mix the index so table buckets spread
+unsigned long long FlatTreeState::key() const {
+	unsigned long long h = current() + 0x9E3779B97F4A7C15ULL;
+
+	h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+	h ^= h >> 31;
+	return maxToMove ? h : ~h;
+}
+
+std::string FlatTreeState::name() const {
+	std::string n = tree.Name(current());
+	return n.empty() ? "#" + std::to_string(current()) : n;
+}
+
+std::unique_ptr<GameState> FlatTreeState::clone() const {
+	return std::unique_ptr<GameState>(new FlatTreeState(*this));
+}
+#pragma endregion
@@ -0,0 +1,28 @@
+#pragma once
+/*************************************************************************************/
+// Flat tree game state class header
+// Walks a FlatTree through the GameState interface, a move is the index of the
+// child node. Lets every engine search flat, generated or loaded trees.
+/*************************************************************************************/
+#include <vector>
+
+#include "FlatTree.h"
+#include "GameState.h"
+
+class FlatTreeState : public GameState {
+public:
+	FlatTreeState(const FlatTree&, unsigned int root = 0, bool maxToMove = true);
+	void generateMoves(std::vector<Move>&) const override;
+	void apply(Move) override;
+	void undo(Move) override;
+	bool isTerminal() const override;
+	int evaluate() const override;
+	unsigned long long key() const override;
+	std::string name() const override;
+	std::unique_ptr<GameState> clone() const override;
+	unsigned int current() const { return path.back(); };
+private:
+	const FlatTree& tree;
+	std::vector<unsigned int> path;			// root to current node
+	bool maxToMove;
+};
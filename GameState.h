@@ -0,0 +1,25 @@
+#pragma once
+/*************************************************************************************/
+// Game state interface
+// Lets the search generate children on demand instead of walking a pre-built tree.
+// Values are always from the max player's point of view.
+/*************************************************************************************/
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef int Move;
+
+class GameState {
+public:
+	virtual ~GameState() {};
+	virtual void generateMoves(std::vector<Move>&) const = 0;
+	virtual void apply(Move) = 0;
+	virtual void undo(Move) = 0;
+	virtual bool isTerminal() const = 0;
+	virtual int evaluate() const = 0;
+	virtual bool probe(int&) const { return false; };		// exact value from an endgame table
+	virtual unsigned long long key() const = 0;				// position hash, includes side to move
+	virtual std::string name() const = 0;
+	virtual std::unique_ptr<GameState> clone() const = 0;
+};
@@ -0,0 +1,118 @@
+/*************************************************************************************/
+// Iterative deepening driver class
+/*************************************************************************************/
+#include <vector>
+
+#include "IterativeDeepening.h"
+
+#pragma region IterativeDeepening
+IterativeDeepening::IterativeDeepening(AlphaBeta& e) : engine(e) {}
+
+DeepeningResult IterativeDeepening::search(Node* root, int maxDepth) {
+	return deepen(root, maxDepth);
+}
+
+DeepeningResult IterativeDeepening::search(GameState& state, int maxDepth) {
+	return deepen(state, maxDepth);
+}
+
+template <class Root>
+DeepeningResult IterativeDeepening::deepen(Root& root, int maxDepth) {
+	DeepeningResult result;
+	long long alpha = engine.min;
+	long long beta = engine.max;
+
+	engine.clearSearchCount();
+	engine.setSearchLimits(nodes, millis);
+	engine.setStopToken(stop);
+	for (int depth = 1; depth <= maxDepth; depth++) {
+		if (stop != nullptr && stop->load())
+			break;
+		DeepeningResult iteration = result;
+		long long delta = window;
+		int fails = 0;
+
+		// Aspiration window around the previous score
+		if (depth > 1 && window > 0) {
+			alpha = (long long)result.value - delta;
+			beta = (long long)result.value + delta;
+		}
+		while (true) {
+			int a = alpha < engine.min ? engine.min : (int)alpha;
+			int b = beta > engine.max ? engine.max : (int)beta;
+			iteration.value = searchRoot(root, depth, a, b, iteration);
+			if (engine.searchAborted())
+				break;
+			// Fail low or high: widen that side and search again, after two
+			// fails that side is opened completely
+			if (iteration.value <= a && a > engine.min) {
+				delta *= 4;
+				alpha = fails >= 1 ? engine.min : (long long)iteration.value - delta;
+			}
+			else if (iteration.value >= b && b < engine.max) {
+				delta *= 4;
+				beta = fails >= 1 ? engine.max : (long long)iteration.value + delta;
+			}
+			else {
+				break;
+			}
+			iteration.researches++;
+			fails++;
+		}
+		if (engine.searchAborted())
+			break;
+		iteration.depth = depth;
+		iteration.nodes = engine.searchCount();
+		result = iteration;
+		if (progress)
+			progress(result);
+	}
+	result.nodes = engine.searchCount();
+	engine.setSearchLimits(0, 0);
+	engine.setStopToken(nullptr);
+	return result;
+}
+
+// Root moves are tried here so the best one is known, root is a max node
+int IterativeDeepening::searchRoot(Node* root, int depth, int alpha, int beta, DeepeningResult& result) {
+	int bestValue = alpha;
+
+	if (root->children.size() == 0)
+		return root->value;
+	for (unsigned int i = 0; i < root->children.size(); i++) {
+		int value = engine.search(root->children[i], depth - 1, bestValue, beta, false);
+		if (engine.searchAborted())
+			break;
+		if (value > bestValue || i == 0) {
+			bestValue = value > bestValue ? value : bestValue;
+			result.bestMove = root->children[i]->name;
+			result.bestIndex = (int)i;
+		}
+		if (beta <= bestValue)
+			break;
+	}
+	return bestValue;
+}
+
+int IterativeDeepening::searchRoot(GameState& state, int depth, int alpha, int beta, DeepeningResult& result) {
+	int bestValue = alpha;
+	std::vector<Move> moves;
+
+	if (state.isTerminal())
+		return state.evaluate();
+	state.generateMoves(moves);
+	for (unsigned int i = 0; i < moves.size(); i++) {
+		state.apply(moves[i]);
+		int value = engine.search(state, depth - 1, bestValue, beta, false);
+		if (!engine.searchAborted() && (value > bestValue || i == 0)) {
+			bestValue = value > bestValue ? value : bestValue;
+			result.bestMove = state.name();
+			result.bestIndex = (int)i;
+		}
+		state.undo(moves[i]);
+		if (engine.searchAborted() || beta <= bestValue)
+			break;
+	}
+	return bestValue;
+}
+#pragma endregion
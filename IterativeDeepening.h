@@ -0,0 +1,46 @@
+#pragma once
+/*************************************************************************************/
+// Iterative deepening driver class header
+// Searches depth 1, 2, 3 ... until a time or node budget runs out and returns the
+// result of the last completed iteration. Each iteration after the first starts
+// with an aspiration window around the previous score and widens it on a fail.
+// A stop token ends the search early with the last completed iteration, and a
+// progress callback sees every completed iteration.
+/*************************************************************************************/
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include "AlphaBeta.h"
+#include "GameState.h"
+
+struct DeepeningResult {
+	int depth = 0;						// last completed depth
+	int value = 0;
+	std::string bestMove = "Not found";
+	int bestIndex = -1;					// root child / move index
+	long long nodes = 0;
+	int researches = 0;					// aspiration fails
+};
+
+class IterativeDeepening {
+public:
+	explicit IterativeDeepening(AlphaBeta&);
+	void setBudget(long long maxMillis, long long maxNodes) { millis = maxMillis; nodes = maxNodes; };
+	void setAspirationWindow(int delta) { window = delta; };
+	void setStopToken(const std::atomic<bool>* s) { stop = s; };
+	void setProgress(std::function<void(const DeepeningResult&)> p) { progress = p; };
+	DeepeningResult search(Node*, int);
+	DeepeningResult search(GameState&, int);
+private:
+	AlphaBeta& engine;
+	long long millis = 0;
+	long long nodes = 0;
+	int window = 50;
+	const std::atomic<bool>* stop = nullptr;
+	std::function<void(const DeepeningResult&)> progress;
+
+	template <class Root> DeepeningResult deepen(Root&, int);
+	int searchRoot(Node*, int, int, int, DeepeningResult&);
+	int searchRoot(GameState&, int, int, int, DeepeningResult&);
+};
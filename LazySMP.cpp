@@ -0,0 +1,92 @@
+/*************************************************************************************/
+// Lazy SMP AlphaBeta class
+/*************************************************************************************/
+#include "FlatTree.h"
+#include "LazySMP.h"
+
+#pragma region LazySMPAlphaBeta
+LazySMPAlphaBeta::LazySMPAlphaBeta(unsigned int threads, unsigned int tableLog2) :
+	pool(threads > 1 ? new ThreadPool(threads - 1) : nullptr), ownTable(tableLog2) {
+	for (unsigned int i = 0; i < (threads > 0 ? threads : 1); i++) {
+		engines.emplace_back(new SimpleAlphaBeta());
+		engines.back()->setSiblingOffset(i);
+	}
+}
+
+// The Node tree is written by the main search, so the helpers share one flat copy
+// of the plies they reach and only read it. Flat tree names hash like node names
+// and the table entries are interchangeable.
+int LazySMPAlphaBeta::search(Node* node, int depth, int alpha, int beta, bool isMax) {
+	TaskGroup group;
+	FlatTree flat(pool != nullptr ? node : nullptr, depth + 1);
+
+	done = false;
+	for (size_t i = 1; i < engines.size(); i++) {
+		SimpleAlphaBeta& helper = *engines[i];
+		prepare(helper, true);
+		pool->run(group, [this, &helper, &flat, i, depth, alpha, beta, isMax]() {
+			for (int d = 1; d <= depth + (int)(i & 1) && !done; d++)
+				helper.search(flat, 0, d, alpha, beta, isMax);
+		});
+	}
+	prepare(*engines[0], false);
+	engines[0]->setRootDepth(depth);
+	int value = engines[0]->search(node, depth, alpha, beta, isMax);
+	done = true;
+	if (pool != nullptr)
+		pool->wait(group);
+	collect();
+	return value;
+}
+
+int LazySMPAlphaBeta::search(GameState& state, int depth, int alpha, int beta, bool isMax) {
+	TaskGroup group;
+	std::vector<std::unique_ptr<GameState>> states;
+
+	done = false;
+	for (size_t i = 1; i < engines.size(); i++)
+		states.push_back(state.clone());
+	for (size_t i = 1; i < engines.size(); i++) {
+		SimpleAlphaBeta& helper = *engines[i];
+		GameState& copy = *states[i - 1];
+		prepare(helper, true);
+		pool->run(group, [this, &helper, &copy, i, depth, alpha, beta, isMax]() {
+			for (int d = 1; d <= depth + (int)(i & 1) && !done; d++)
+				helper.search(copy, d, alpha, beta, isMax);
+		});
+	}
+	prepare(*engines[0], false);
+	engines[0]->setRootDepth(depth);
+	int value = engines[0]->search(state, depth, alpha, beta, isMax);
+	done = true;
+	if (pool != nullptr)
+		pool->wait(group);
+	collect();
+	return value;
+}
+
+int LazySMPAlphaBeta::staticEvaluator() {
+	return 0;
+}
+
+// Helpers share the budget, but are stopped by the main search rather than the caller
+void LazySMPAlphaBeta::prepare(SimpleAlphaBeta& engine, bool helper) {
+	engine.clearSearchCount();
+	engine.setTranspositionTable(table != nullptr ? table : &ownTable);
+	engine.setMoveOrderer(helper ? nullptr : orderer);
+	engine.setReadOnly(helper);
+	shareLimits(engine);
+	if (helper)
+		engine.setStopToken(&done);
+}
+
+void LazySMPAlphaBeta::collect() {
+	for (std::unique_ptr<SimpleAlphaBeta>& e : engines) {
+		nodeCount += e->searchCount();
+		tableHits += e->hitCount();
+		tableMisses += e->missCount();
+		stats.merge(e->searchStats());
+	}
+	aborted = engines[0]->searchAborted();
+}
+#pragma endregion
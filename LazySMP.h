@@ -0,0 +1,38 @@
+#pragma once
+/*************************************************************************************/
+// Lazy SMP AlphaBeta class header
+// Every thread runs its own serial search of the whole tree, the threads only
+// meet through a shared lock-free transposition table. The calling thread is the
+// main search and its result is returned. Helpers deepen from depth 1 up to the
+// main depth, every other one a ply deeper, and walk siblings in their own order,
+// so their table entries cut the main search short. Helpers stop when the main
+// search returns. Limits are per thread, node counts and statistics are summed.
+/*************************************************************************************/
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AlphaBeta.h"
+#include "SimpleAlphaBeta.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+class LazySMPAlphaBeta : public AlphaBeta {
+public:
+	// The table is used when none is set with setTranspositionTable
+	explicit LazySMPAlphaBeta(unsigned int threads = std::thread::hardware_concurrency(), unsigned int tableLog2 = 20);
+	int search(Node*, int, int, int, bool) override;
+	int search(GameState&, int, int, int, bool) override;
+	int staticEvaluator() override;
+	unsigned int threadCount() const { return (unsigned int)engines.size(); };
+	SimpleAlphaBeta& mainSearch() { return *engines[0]; };	// principal variation of the last search
+private:
+	std::unique_ptr<ThreadPool> pool;						// helper threads, none for one thread
+	TranspositionTable ownTable;
+	std::vector<std::unique_ptr<SimpleAlphaBeta>> engines;	// 0 is the calling thread
+	std::atomic<bool> done{ false };
+
+	void prepare(SimpleAlphaBeta&, bool);
+	void collect();
+};
@@ -0,0 +1,308 @@
+/*************************************************************************************/
+// Monte Carlo tree search class
+/*************************************************************************************/
+#include <cmath>
+#include <limits>
+
+#include "MonteCarloSearch.h"
+
+#pragma region Games
+// Walks a Node tree, nothing is written so every thread shares it
+class MonteCarloSearch::NodeGame {
+public:
+	explicit NodeGame(const Node* r) : root(r), current(r) {};
+	bool isLeaf() const { return current->children.empty(); };
+	int value() const { return current->value; };
+	void expand(TreeNode& t, NodePool& pool) {
+		unsigned int count = (unsigned int)current->children.size();
+		t.children = pool.allocate(count);
+		for (unsigned int i = 0; i < count; i++)
+			t.children[i].node = current->children[i];
+		t.childCount = count;
+	};
+	void enter(const TreeNode& child) { current = child.node; };
+	void step(std::mt19937& rng, Playout policy, bool isMax) {
+		const std::vector<Node*>& children = current->children;
+		if (policy == Playout::Greedy) {
+			for (const Node* c : children) {
+				if (c->children.empty() && (isMax ? c->value > 0 : c->value < 0)) {
+					current = c;
+					return;
+				}
+			}
+		}
+		current = children[rng() % children.size()];
+	};
+	void restart() { current = root; };
+private:
+	const Node* root;
+	const Node* current;
+};
+
+// Plays moves on a game state and takes them back for the next playout
+class MonteCarloSearch::StateGame {
+public:
+	explicit StateGame(GameState& s) : state(s) {};
+	bool isLeaf() const { int exact = 0; return state.isTerminal() || state.probe(exact); };
+	int value() const { int exact = 0; return state.probe(exact) ? exact : state.evaluate(); };
+	void expand(TreeNode& t, NodePool& pool) {
+		state.generateMoves(moves);
+		t.children = pool.allocate((unsigned int)moves.size());
+		for (unsigned int i = 0; i < moves.size(); i++)
+			t.children[i].move = moves[i];
+		t.childCount = (unsigned int)moves.size();
+	};
+	void enter(const TreeNode& child) { play(child.move); };
+	void step(std::mt19937& rng, Playout policy, bool isMax) {
+		state.generateMoves(moves);
+		if (policy == Playout::Greedy) {
+			for (Move m : moves) {
+				state.apply(m);
+				bool win = isLeaf() && (isMax ? value() > 0 : value() < 0);
+				state.undo(m);
+				if (win) {
+					play(m);
+					return;
+				}
+			}
+		}
+		play(moves[rng() % moves.size()]);
+	};
+	void restart() {
+		for (; !path.empty(); path.pop_back())
+			state.undo(path.back());
+	};
+private:
+	GameState& state;
+	std::vector<Move> moves;
+	std::vector<Move> path;					// moves played since the root
+
+	void play(Move m) { state.apply(m); path.push_back(m); };
+};
+#pragma endregion
+
+#pragma region NodePool
+void MonteCarloSearch::TreeNode::reset() {
+	state.store(0, std::memory_order_relaxed);
+	visits.store(0, std::memory_order_relaxed);
+	virtualLoss.store(0, std::memory_order_relaxed);
+	valueSum.store(0, std::memory_order_relaxed);
+	children = nullptr;
+	childCount = 0;
+	move = 0;
+	node = nullptr;
+}
+
+// A run larger than a block gets a block of its own
+MonteCarloSearch::TreeNode* MonteCarloSearch::NodePool::allocate(unsigned int count) {
+	if (current >= blocks.size() || used + count > sizes[current]) {
+		if (current < blocks.size())
+			current++;
+		used = 0;
+		if (current >= blocks.size() || sizes[current] < count) {
+			unsigned int size = count > blockSize ? count : blockSize;
+			blocks.emplace(blocks.begin() + current, new TreeNode[size]);
+			sizes.insert(sizes.begin() + current, size);
+		}
+	}
+	TreeNode* run = &blocks[current][used];
+	used += count;
+	for (unsigned int i = 0; i < count; i++)
+		run[i].reset();
+	return run;
+}
+
+size_t MonteCarloSearch::NodePool::bytes() const {
+	size_t total = 0;
+	for (unsigned int s : sizes)
+		total += s * sizeof(TreeNode);
+	return total;
+}
+#pragma endregion
+
+#pragma region MonteCarloSearch
+MonteCarloSearch::MonteCarloSearch(unsigned int threads, long long maxMillis, long long maxPlayouts) :
+	pool(threads > 1 ? new ThreadPool(threads - 1) : nullptr), pools(threads > 0 ? threads : 1), millis(maxMillis), playoutLimit(maxPlayouts) {}
+
+int MonteCarloSearch::search(Node* node, int depth, int, int, bool isMax) {
+	std::vector<std::unique_ptr<NodeGame>> games;
+
+	for (size_t i = 0; i < pools.size(); i++)
+		games.emplace_back(new NodeGame(node));
+	return run(games, depth, isMax);
+}
+
+// Helper threads play on clones, the calling thread on the state itself
+int MonteCarloSearch::search(GameState& state, int depth, int, int, bool isMax) {
+	std::vector<std::unique_ptr<GameState>> clones;
+	std::vector<std::unique_ptr<StateGame>> games;
+
+	games.emplace_back(new StateGame(state));
+	for (size_t i = 1; i < pools.size(); i++) {
+		clones.push_back(state.clone());
+		games.emplace_back(new StateGame(*clones.back()));
+	}
+	return run(games, depth, isMax);
+}
+
+int MonteCarloSearch::staticEvaluator() {
+	return 0;
+}
+
+size_t MonteCarloSearch::poolBytes() const {
+	size_t total = 0;
+	for (const NodePool& p : pools)
+		total += p.bytes();
+	return total;
+}
+
+template <class Game>
+int MonteCarloSearch::run(std::vector<std::unique_ptr<Game>>& games, int depth, bool isMax) {
+	TaskGroup group;
+	std::vector<long long> nodes(games.size(), 0);
+	Game& game = *games[0];
+
+	for (NodePool& p : pools)
+		p.clear();
+	done = false;
+	playouts = 0;
+	walked = 0;
+	lowest = std::numeric_limits<int>::max();
+	highest = std::numeric_limits<int>::min();
+	deadline = millis > 0 ? std::chrono::steady_clock::now() + std::chrono::milliseconds(millis) : std::chrono::steady_clock::time_point::max();
+	rootChoice = -1;
+	rootStats.clear();
+	if (depth <= 0 || game.isLeaf()) {
+		nodeCount++;
+		return game.value();
+	}
+
+	TreeNode* root = pools[0].allocate(1);
+	game.expand(*root, pools[0]);
+	root->state = 2;
+	for (unsigned int i = 1; i < games.size(); i++) {
+		Game& helper = *games[i];
+		pool->run(group, [this, &helper, &nodes, root, depth, isMax, i]() { nodes[i] = worker(helper, root, depth, isMax, i); });
+	}
+	nodes[0] = worker(game, root, depth, isMax, 0);
+	if (pool != nullptr)
+		pool->wait(group);
+	for (long long n : nodes)
+		nodeCount += n;
+
+	for (unsigned int i = 0; i < root->childCount; i++) {
+		RootChildStats s;
+		s.index = (int)i;
+		s.visits = root->children[i].visits;
+		s.mean = s.visits > 0 ? (double)root->children[i].valueSum / s.visits : 0.0;
+		rootStats.push_back(s);
+		if (rootChoice < 0 || s.visits > rootStats[rootChoice].visits)
+			rootChoice = (int)i;				// the most visited root child
+	}
+	return rootStats[rootChoice].visits > 0 ? (int)std::lround(rootStats[rootChoice].mean) : game.value();
+}
+
+// One thread's playouts, returns the plies it walked
+template <class Game>
+long long MonteCarloSearch::worker(Game& game, TreeNode* root, int depth, bool isMax, unsigned int thread) {
+	std::mt19937 rng(seed + thread * 7919);
+	std::vector<TreeNode*> path;
+	long long nodes = 0;
+
+	while (!done.load(std::memory_order_relaxed)) {
+		TreeNode* t = root;
+		bool side = isMax;
+		int d = depth;
+
+		path.clear();
+		path.push_back(root);
+		root->virtualLoss++;
+		// Selection, a node is expanded by the first thread to visit it again
+		while (d > 0 && !game.isLeaf()) {
+			if (t->state.load(std::memory_order_acquire) != 2) {
+				int expected = 0;
+				if (t->visits.load(std::memory_order_relaxed) == 0 || !t->state.compare_exchange_strong(expected, 1))
+					break;
+				game.expand(*t, pools[thread]);
+				t->state.store(2, std::memory_order_release);
+			}
+			t = select(t, side);
+			game.enter(*t);
+			t->virtualLoss++;
+			path.push_back(t);
+			side = !side;
+			d--;
+			if (countPly(nodes))
+				done = true;
+			if (t->visits.load(std::memory_order_relaxed) == 0)
+				break;
+		}
+		// Playout to the horizon
+		for (; d > 0 && !game.isLeaf(); d--) {
+			game.step(rng, policy, side);
+			side = !side;
+			if (countPly(nodes))
+				done = true;
+		}
+		int value = game.value();
+		observe(value);
+		for (TreeNode* n : path) {
+			n->valueSum += value;
+			n->visits++;
+			n->virtualLoss--;
+		}
+		game.restart();
+		if (budgetSpent())
+			done = true;
+	}
+	return nodes;
+}
+
+// Upper confidence bound for the side to move. Untried children come first and
+// virtual losses count as visits that scored nothing.
+MonteCarloSearch::TreeNode* MonteCarloSearch::select(TreeNode* t, bool isMax) const {
+	double lo = lowest.load(std::memory_order_relaxed);
+	double hi = highest.load(std::memory_order_relaxed);
+	double range = hi > lo ? hi - lo : 1.0;
+	double logParent = std::log((double)(t->visits.load(std::memory_order_relaxed) + t->virtualLoss.load(std::memory_order_relaxed)) + 1.0);
+	TreeNode* chosen = &t->children[0];
+	double bestScore = -std::numeric_limits<double>::infinity();
+
+	for (unsigned int i = 0; i < t->childCount; i++) {
+		TreeNode* c = &t->children[i];
+		long long n = c->visits.load(std::memory_order_relaxed);
+		long long trials = n + c->virtualLoss.load(std::memory_order_relaxed);
+		if (trials == 0)
+			return c;
+		double mean = n > 0 ? (double)c->valueSum.load(std::memory_order_relaxed) / n : lo;
+		double score = (isMax ? mean - lo : hi - mean) / range * n / trials + exploration * std::sqrt(logParent / trials);
+		if (score > bestScore) {
+			bestScore = score;
+			chosen = c;
+		}
+	}
+	return chosen;
+}
+
+void MonteCarloSearch::observe(int value) {
+	int low = lowest.load(std::memory_order_relaxed);
+	int high = highest.load(std::memory_order_relaxed);
+
+	while (value < low && !lowest.compare_exchange_weak(low, value)) {}
+	while (value > high && !highest.compare_exchange_weak(high, value)) {}
+}
+
+// Plies are added to the shared count 1024 at a time, so setSearchLimits budgets
+// all threads together and the count is only touched every 1024 plies
+bool MonteCarloSearch::countPly(long long& nodes) {
+	return (++nodes & 1023) == 0 && limitReached(walked += 1024);
+}
+
+bool MonteCarloSearch::budgetSpent() {
+	long long n = ++playouts;
+
+	if (playoutLimit > 0 && n >= playoutLimit)
+		return true;
+	return (n & 15) == 0 && std::chrono::steady_clock::now() >= deadline;
+}
+#pragma endregion
@@ -0,0 +1,100 @@
+#pragma once
+/*************************************************************************************/
+// Monte Carlo tree search class header
+// UCT: descend by the upper confidence bound, expand a node on its second visit,
+// play random (or greedy) moves down to the horizon and back the value up the
+// path. All threads grow one shared tree. A thread passing through a node adds a
+// virtual loss, so the others spread over different lines until its playout is
+// backed up. Tree nodes come from a block pool per thread and are freed together
+// at the end of a search. The search runs until its time or playout budget is
+// spent, a stop token or setSearchLimits ends it early as an abort.
+// alpha and beta are ignored, depth is the horizon in plies from the root where
+// a position is evaluated like an alpha-beta leaf. The value returned is the mean
+// playout value of the most visited root child.
+/*************************************************************************************/
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "AlphaBeta.h"
+#include "GameState.h"
+#include "ThreadPool.h"
+
+enum class Playout { Random, Greedy };		// greedy takes a move that ends the game best for the mover
+
+struct RootChildStats {
+	int index = -1;							// root child / move index
+	long long visits = 0;
+	double mean = 0.0;						// mean playout value, max's point of view
+};
+
+class MonteCarloSearch : public AlphaBeta {
+public:
+	explicit MonteCarloSearch(unsigned int threads = std::thread::hardware_concurrency(), long long maxMillis = 1000, long long maxPlayouts = 0);
+	int search(Node*, int, int, int, bool) override;
+	int search(GameState&, int, int, int, bool) override;
+	int staticEvaluator() override;
+	void setBudget(long long maxMillis, long long maxPlayouts) { millis = maxMillis; playoutLimit = maxPlayouts; };	// 0 is unlimited
+	void setExploration(double c) { exploration = c; };
+	void setPlayout(Playout p) { policy = p; };
+	void setSeed(unsigned int s) { seed = s; };
+	unsigned int threadCount() const { return (unsigned int)pools.size(); };
+	const std::vector<RootChildStats>& rootChildren() const { return rootStats; };
+	long long playoutCount() const { return playouts; };
+	size_t poolBytes() const;
+private:
+	struct TreeNode {
+		std::atomic<int> state;				// 0 leaf, 1 expanding, 2 expanded
+		std::atomic<long long> visits;
+		std::atomic<long long> virtualLoss;
+		std::atomic<long long> valueSum;
+		TreeNode* children;					// set before state becomes 2
+		unsigned int childCount;
+		Move move;							// from the parent, for a game state
+		const Node* node;					// for a Node tree
+		void reset();
+	};
+
+	// Contiguous runs of nodes from fixed blocks, one pool per thread so
+	// allocation takes no lock
+	class NodePool {
+	public:
+		TreeNode* allocate(unsigned int);
+		void clear() { used = 0; current = 0; };	// keeps the blocks
+		size_t bytes() const;
+	private:
+		static const unsigned int blockSize = 4096;
+		std::vector<std::unique_ptr<TreeNode[]>> blocks;
+		std::vector<unsigned int> sizes;
+		size_t current = 0;
+		unsigned int used = 0;
+	};
+
+	class NodeGame;
+	class StateGame;
+
+	std::unique_ptr<ThreadPool> pool;				// helper threads, none for one thread
+	std::vector<NodePool> pools;					// 0 is the calling thread
+	long long millis;
+	long long playoutLimit;
+	double exploration = 1.41421356;
+	Playout policy = Playout::Random;
+	unsigned int seed = 1;
+	std::atomic<bool> done{ false };
+	std::atomic<long long> playouts{ 0 };
+	std::atomic<long long> walked{ 0 };			// plies of all threads, in steps of 1024
+	std::atomic<int> lowest{ 0 };					// playout values seen, to scale them to [0, 1]
+	std::atomic<int> highest{ 0 };
+	std::chrono::steady_clock::time_point deadline;
+	std::vector<RootChildStats> rootStats;
+
+	template <class Game> int run(std::vector<std::unique_ptr<Game>>&, int, bool);
+	template <class Game> long long worker(Game&, TreeNode*, int, bool, unsigned int);
+	TreeNode* select(TreeNode*, bool) const;
+	void observe(int);
+	bool countPly(long long&);
+	bool budgetSpent();
+};
@@ -0,0 +1,46 @@
+/*************************************************************************************/
+// Move ordering class
+/*************************************************************************************/
+#include "MoveOrdering.h"
+
+#pragma region MoveOrderer
+MoveOrderer::MoveOrderer(unsigned int historyLog2) :
+	history(1ULL << historyLog2, 0), mask((1ULL << historyLog2) - 1) {}
+
+int MoveOrderer::score(unsigned long long move, int ply, unsigned long long hashMove) const {
+	if (hashMove != 0 && move == hashMove)
+		return hashScore;
+	if (ply >= 0 && ply < (int)killers.size() && (killers[ply][0] == move || killers[ply][1] == move))
+		return killerScore;
+	return history[move & mask];
+}
+
+// A move caused a cutoff: make it a killer of the ply and raise its history
+void MoveOrderer::cutoff(unsigned long long move, int ply, int depth, bool first) {
+	cutoffs++;
+	if (first)
+		firstMoveCutoffs++;
+	if (ply >= (int)killers.size())
+		killers.resize(ply + 1, { { 0, 0 } });
+	if (ply >= 0 && killers[ply][0] != move) {
+		killers[ply][1] = killers[ply][0];
+		killers[ply][0] = move;
+	}
+	int& h = history[move & mask];
+	h += depth * depth;
+	if (h >= killerScore)
+		age();
+}
+
+void MoveOrderer::age() {
+	for (int& h : history)
+		h /= 2;
+}
+
+void MoveOrderer::clear() {
+	killers.clear();
+	std::fill(history.begin(), history.end(), 0);
+	cutoffs = 0;
+	firstMoveCutoffs = 0;
+}
+#pragma endregion
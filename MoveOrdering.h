@@ -0,0 +1,68 @@
+#pragma once
+/*************************************************************************************/
+// Move ordering class header
+// Sorts the children of a node before they are searched: the hash move from the
+// transposition table first, then the killer moves of the ply, then the rest by
+// history score. Moves are identified by a 64 bit key, for a tree node the hash
+// of the child position, for a game state the Move itself. Killer slots are
+// indexed by the ply, the distance from the root of the search call, so
+// searches of different depths share them. A negative ply has no killers.
+/*************************************************************************************/
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+class MoveOrderer {
+public:
+	explicit MoveOrderer(unsigned int historyLog2 = 12);
+	template <class T, class KeyFn> void order(std::vector<T>&, int, unsigned long long, KeyFn);
+	void cutoff(unsigned long long, int, int, bool);	// move, ply, depth, first move searched
+	void age();											// halve the history between searches
+	void clear();
+	long long cutoffCount() const { return cutoffs; };
+	long long firstMoveCutoffCount() const { return firstMoveCutoffs; };
+	double firstMoveCutoffRate() const { return cutoffs == 0 ? 0.0 : (double)firstMoveCutoffs / cutoffs; };
+private:
+	static const int hashScore = 1 << 30;
+	static const int killerScore = 1 << 29;
+
+	std::vector<std::array<unsigned long long, 2>> killers;	// two slots per ply
+	std::vector<int> history;
+	unsigned long long mask;
+	long long cutoffs = 0;
+	long long firstMoveCutoffs = 0;
+	std::vector<std::pair<int, unsigned int>> scores;
+
+	int score(unsigned long long, int, unsigned long long) const;
+};
+
+// Reorder items in place, key maps an item to its move key. The sorted order is
+// applied cycle by cycle, so nothing is allocated once scores has grown.
+template <class T, class KeyFn>
+void MoveOrderer::order(std::vector<T>& items, int ply, unsigned long long hashMove, KeyFn key) {
+	if (items.size() < 2)
+		return;
+	scores.clear();
+	for (unsigned int i = 0; i < items.size(); i++)
+		scores.push_back({ score(key(items[i]), ply, hashMove), i });
+	// Equal scores keep their order through the index, stable_sort would allocate
+	std::sort(scores.begin(), scores.end(), [](const std::pair<int, unsigned int>& a, const std::pair<int, unsigned int>& b) {
+		return a.first != b.first ? a.first > b.first : a.second < b.second;
+	});
+	// Slot i takes the item from scores[i].second, a placed slot points at itself
+	for (unsigned int i = 0; i < items.size(); i++) {
+		if (scores[i].second == i)
+			continue;
+		T first = items[i];
+		unsigned int j = i;
+		while (scores[j].second != i) {
+			unsigned int from = scores[j].second;
+			items[j] = items[from];
+			scores[j].second = j;
+			j = from;
+		}
+		items[j] = first;
+		scores[j].second = j;
+	}
+}
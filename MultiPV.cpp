@@ -0,0 +1,76 @@
+/*************************************************************************************/
+// Multi-PV root search
+/*************************************************************************************/
+#include <algorithm>
+
+#include "MultiPV.h"
+
+namespace {
+	// Below any equal score already ranked, so ties keep the earlier move
+	void insertRanked(std::vector<RootMove>& top, RootMove&& move, unsigned int k) {
+		auto at = std::upper_bound(top.begin(), top.end(), move, [](const RootMove& a, const RootMove& b) { return a.value > b.value; });
+		top.insert(at, std::move(move));
+		if (top.size() > k)
+			top.pop_back();
+	}
+}
+
+#pragma region MultiPV
+std::vector<RootMove> SearchMultiPV(SimpleAlphaBeta& engine, FlatTree& tree, int depth, unsigned int k) {
+	std::vector<RootMove> top;
+	unsigned int first = tree.firstChild[0];
+
+	if (depth <= 0 || k == 0)
+		return top;
+	for (unsigned int c = first; c < first + tree.childCount[0]; c++) {
+		int alpha = top.size() < k ? engine.min : top.back().value;
+		int value = engine.search(tree, c, depth - 1, alpha, engine.max, false);
+		if (engine.searchAborted())
+			break;
+		if (top.size() < k || value > alpha) {
+			RootMove move;
+			move.index = (int)(c - first);
+			move.value = value;
+			move.line.push_back(tree.Name(c));
+			for (unsigned int n : engine.flatVariation(depth - 1))
+				move.line.push_back(tree.Name(n));
+			insertRanked(top, std::move(move), k);
+		}
+	}
+	return top;
+}
+
+std::vector<RootMove> SearchMultiPV(SimpleAlphaBeta& engine, GameState& state, int depth, unsigned int k) {
+	std::vector<RootMove> top;
+	std::vector<Move> moves;
+
+	if (depth <= 0 || k == 0 || state.isTerminal())
+		return top;
+	state.generateMoves(moves);
+	for (unsigned int i = 0; i < moves.size(); i++) {
+		int alpha = top.size() < k ? engine.min : top.back().value;
+		state.apply(moves[i]);
+		int value = engine.search(state, depth - 1, alpha, engine.max, false);
+		if (!engine.searchAborted() && (top.size() < k || value > alpha)) {
+			RootMove move;
+			move.index = (int)i;
+			move.value = value;
+			move.line.push_back(state.name());
+
+			// Replay the variation for its names
+			const std::vector<Move> line = engine.moveVariation(depth - 1);
+			for (Move m : line) {
+				state.apply(m);
+				move.line.push_back(state.name());
+			}
+			for (auto m = line.rbegin(); m != line.rend(); ++m)
+				state.undo(*m);
+			insertRanked(top, std::move(move), k);
+		}
+		state.undo(moves[i]);
+		if (engine.searchAborted())
+			break;
+	}
+	return top;
+}
+#pragma endregion
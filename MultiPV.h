@@ -0,0 +1,23 @@
+#pragma once
+/*************************************************************************************/
+// Multi-PV root search header
+// Ranks the top k root moves with exact scores in a single pass over the root.
+// Each root move is searched with alpha at the k-th best score found so far:
+// moves that cannot enter the top k fail low cheaply, the others come back
+// exact, together with their principal variation. The root is a max node.
+/*************************************************************************************/
+#include <string>
+#include <vector>
+
+#include "FlatTree.h"
+#include "GameState.h"
+#include "SimpleAlphaBeta.h"
+
+struct RootMove {
+	int index = -1;							// root child / move index
+	int value = 0;
+	std::vector<std::string> line;			// names along the variation, the move first
+};
+
+std::vector<RootMove> SearchMultiPV(SimpleAlphaBeta&, FlatTree&, int depth, unsigned int k);
+std::vector<RootMove> SearchMultiPV(SimpleAlphaBeta&, GameState&, int depth, unsigned int k);
@@ -0,0 +1,102 @@
+/*************************************************************************************/
+// Interned node names
+/*************************************************************************************/
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <unordered_map>
+
+#include "NamePool.h"
+
+namespace {
+	// Node based, so entries never move as the pool grows
+	std::unordered_map<std::string, PooledName>& pool() {
+		static std::unordered_map<std::string, PooledName> names;
+		return names;
+	}
+
+	std::shared_timed_mutex& poolLock() {
+		static std::shared_timed_mutex lock;
+		return lock;
+	}
+}
+
+#pragma region InternedName
+InternedName::InternedName() : entry(NamePool::Empty()) {}
+InternedName::InternedName(const std::string& name) : entry(NamePool::Intern(name)) {}
+InternedName::InternedName(const char* name) : entry(NamePool::Intern(std::string(name))) {}
+
+InternedName::InternedName(const InternedName& other) : entry(other.entry) {
+	if (entry != NamePool::Empty())
+		entry->second.handles++;
+}
+
+InternedName& InternedName::operator=(const InternedName& other) {
+	if (entry != other.entry) {
+		if (other.entry != NamePool::Empty())
+			other.entry->second.handles++;
+		NamePool::Release(entry);
+		entry = other.entry;
+	}
+	return *this;
+}
+
+InternedName::~InternedName() {
+	NamePool::Release(entry);
+}
+#pragma endregion
+
+#pragma region NamePool
+const NamePool::Entry* NamePool::Intern(const std::string& name) {
+	if (name.empty())
+		return Empty();
+	{
+		std::shared_lock<std::shared_timed_mutex> guard(poolLock());
+		auto found = pool().find(name);
+		if (found != pool().end()) {
+			found->second.handles++;
+			return &*found;
+		}
+	}
+	std::unique_lock<std::shared_timed_mutex> guard(poolLock());
+	auto found = pool().emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple(Hash(name.c_str()))).first;
+	found->second.handles++;
+	return &*found;
+}
+
+// Handles above one drop without the lock. The last one drops under the
+// exclusive lock, so no lookup can take a handle to a name being removed.
+void NamePool::Release(const Entry* entry) {
+	if (entry == Empty())
+		return;
+	std::atomic<long long>& handles = entry->second.handles;
+	long long count = handles.load();
+	while (count > 1) {
+		if (handles.compare_exchange_weak(count, count - 1))
+			return;
+	}
+	std::unique_lock<std::shared_timed_mutex> guard(poolLock());
+	if (--handles == 0)
+		pool().erase(pool().find(entry->first));
+}
+
+const NamePool::Entry* NamePool::Empty() {
+	static const Entry empty(std::piecewise_construct, std::forward_as_tuple(), std::forward_as_tuple(Hash("")));
+	return &empty;
+}
+
+unsigned long long NamePool::Hash(const char* name) {
+	unsigned long long h = 14695981039346656037ULL;
+
+	for (; *name != '\0'; name++) {
+		h ^= (unsigned char)*name;
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+size_t NamePool::size() {
+	std::shared_lock<std::shared_timed_mutex> guard(poolLock());
+	return pool().size();
+}
+#pragma endregion
@@ -0,0 +1,53 @@
+#pragma once
+/*************************************************************************************/
+// Interned node names
+// The game trees repeat a few position names ("0-I-I", "0-0-0", ...) thousands of
+// times. Every distinct name is stored once in a process wide pool together with
+// its FNV-1a hash, and a node keeps an 8 byte handle to it. A name leaves the pool
+// with its last handle, so long runs only hold the names of live nodes. The empty
+// name is not pooled and costs nothing. Looking up a pooled name takes a shared
+// lock, adding or removing one an exclusive lock, reading a name none.
+/*************************************************************************************/
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <utility>
+
+struct PooledName {
+	unsigned long long hash;				// FNV-1a of the text
+	mutable std::atomic<long long> handles{ 0 };	// InternedNames referring to it
+
+	explicit PooledName(unsigned long long h) : hash(h) {};
+};
+
+class InternedName {
+public:
+	InternedName();							// the empty name
+	InternedName(const std::string&);
+	InternedName(const char*);
+	InternedName(const InternedName&);
+	InternedName& operator=(const InternedName&);
+	~InternedName();
+
+	const std::string& str() const { return entry->first; };
+	const char* c_str() const { return entry->first.c_str(); };
+	operator const std::string&() const { return entry->first; };
+	unsigned long long hash() const { return entry->second.hash; };
+	bool operator==(const InternedName& other) const { return entry == other.entry; };
+	bool operator!=(const InternedName& other) const { return entry != other.entry; };
+private:
+	const std::pair<const std::string, PooledName>* entry;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const InternedName& name) { return out << name.str(); }
+
+class NamePool {
+public:
+	typedef std::pair<const std::string, PooledName> Entry;
+
+	static const Entry* Intern(const std::string&);			// one more handle, the empty name is not counted
+	static void Release(const Entry*);					// one handle less, the last removes the name
+	static const Entry* Empty();
+	static unsigned long long Hash(const char*);		// FNV-1a
+	static size_t size();								// distinct names
+};
@@ -0,0 +1,120 @@
+/*************************************************************************************/
+// Nim game state class
+/*************************************************************************************/
+#include <sstream>
+#include <stdexcept>
+
+#include "NimState.h"
+
+#pragma region NimState
+// Parse "I-II-II" style notation, '0' is an empty heap
+NimState::NimState(const std::string& position, bool m, bool max) : misere(m), maxToMove(max) {
+	std::stringstream ss(position);
+	std::string heap;
+
+	while (std::getline(ss, heap, '-')) {
+		if (heap == "0") {
+			heaps.push_back(0);
+		}
+		else if (heap.find_first_not_of('I') == std::string::npos && heap.size() < 256) {
+			heaps.push_back((int)heap.size());
+		}
+		else {
+			throw std::invalid_argument("Invalid Nim heap '" + heap + "' in " + position);
+		}
+	}
+	if (heaps.empty())
+		throw std::invalid_argument("Empty Nim position");
+}
+
+void NimState::generateMoves(std::vector<Move>& moves) const {
+	moves.clear();
+	for (int h = 0; h < (int)heaps.size(); h++) {
+		for (int take = 1; take <= heaps[h]; take++)
+			moves.push_back(makeMove(h, take));
+	}
+}
+
+void NimState::apply(Move m) {
+	heaps[moveHeap(m)] -= moveTake(m);
+	maxToMove = !maxToMove;
+}
+
+void NimState::undo(Move m) {
+	heaps[moveHeap(m)] += moveTake(m);
+	maxToMove = !maxToMove;
+}
+
+bool NimState::isTerminal() const {
+	for (int h : heaps) {
+		if (h > 0)
+			return false;
+	}
+	return true;
+}
+
+// With no stones left the previous player took the last one
+int NimState::evaluate() const {
+	if (!isTerminal())
+		return 0;
+	bool maxWins = misere ? maxToMove : !maxToMove;
+	return maxWins ? winValue : -winValue;
+}
+
+// A table built for the other variant does not apply
+bool NimState::probe(int& value) const {
+	bool win = false;
+	unsigned int distance = 0;
+
+	if (tablebase == nullptr || tablebase->isMisere() != misere)
+		return false;
+	if (!tablebase->probe(heaps.data(), (unsigned int)heaps.size(), win, distance))
+		return false;
+	value = win == maxToMove ? winValue : -winValue;
+	return true;
+}
+
+// Heaps never exceed 255 stones, see the constructor
+unsigned long long NimState::packedKey() const {
+	unsigned long long packed = maxToMove ? 1ULL << 63 : 0;
+
+	if (heaps.size() > 7)
+		return 0;
+	for (unsigned int h = 0; h < heaps.size(); h++)
+		packed |= (unsigned long long)heaps[h] << (8 * h);
+	return packed | (unsigned long long)heaps.size() << 56;
+}
+
+// Mixed packed key, FNV-1a over the heap sizes when they do not fit
+unsigned long long NimState::key() const {
+	unsigned long long h = packedKey();
+
+	if (h != 0) {
+		h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+		return h ^ (h >> 31);
+	}
+	h = 14695981039346656037ULL;
+	for (int heap : heaps) {
+		h ^= (unsigned long long)heap;
+		h *= 1099511628211ULL;
+	}
+	h ^= maxToMove ? 0x9E3779B97F4A7C15ULL : 0;
+	return h;
+}
+
+std::string NimState::name() const {
+	std::string n;
+
+	for (unsigned int h = 0; h < heaps.size(); h++) {
+		if (h > 0)
+			n += '-';
+		n += heaps[h] == 0 ? std::string("0") : std::string(heaps[h], 'I');
+	}
+	return n;
+}
+
+std::unique_ptr<GameState> NimState::clone() const {
+	return std::unique_ptr<GameState>(new NimState(*this));
+}
+#pragma endregion
@@ -0,0 +1,42 @@
+#pragma once
+/*************************************************************************************/
+// Nim game state class header
+// Positions use the heap notation of the scenario trees, e.g. "I-II-II" or "0-I-II".
+// A move takes one or more stones from a single heap. In normal play the player
+// taking the last stone wins, in misere play that player loses.
+/*************************************************************************************/
+#include <string>
+#include <vector>
+
+#include "GameState.h"
+#include "NimTablebase.h"
+
+class NimState : public GameState {
+public:
+	static const int winValue = 100;
+
+	NimState(const std::string&, bool misere = false, bool maxToMove = true);
+	void generateMoves(std::vector<Move>&) const override;
+	void apply(Move) override;
+	void undo(Move) override;
+	bool isTerminal() const override;
+	int evaluate() const override;
+	bool probe(int&) const override;
+	unsigned long long key() const override;
+	// Heap sizes a byte each, heap count in bits 56-58 and side to move in bit 63.
+	// 0 when there are more than 7 heaps.
+	unsigned long long packedKey() const;
+	std::string name() const override;
+	std::unique_ptr<GameState> clone() const override;
+
+	void setTablebase(const NimTablebase* t) { tablebase = t; };		// not owned, kept by clones
+
+	static Move makeMove(int heap, int take) { return (heap << 8) | take; };
+	static int moveHeap(Move m) { return m >> 8; };
+	static int moveTake(Move m) { return m & 0xFF; };
+private:
+	std::vector<int> heaps;
+	bool misere;
+	bool maxToMove;
+	const NimTablebase* tablebase = nullptr;
+};
@@ -0,0 +1,202 @@
+/*************************************************************************************/
+// Nim endgame tablebase class
+/*************************************************************************************/
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "NimTablebase.h"
+
+#pragma region NimTablebase
+NimTablebase::NimTablebase(unsigned int count, unsigned int max, bool m) : heaps(count), maxHeap(max), misere(m) {
+	if (heaps == 0 || heaps > maxHeapCount)
+		throw std::invalid_argument("Tablebase heap count must be 1 to " + std::to_string(maxHeapCount));
+	if (maxHeap > maxStones)
+		throw std::invalid_argument("Tablebase heap size must be at most " + std::to_string(maxStones));
+	init();
+	words.assign((size_t)((entryCount * entryBits + 63) / 64), 0);
+}
+
+NimTablebase::NimTablebase(const std::string& path) {
+	NimTablebaseHeader header;
+	std::ifstream in(path, std::ios::binary);
+
+	if (!in)
+		throw std::runtime_error("Cannot open tablebase " + path);
+	if (!in.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, "ABPN", 4) != 0)
+		throw std::runtime_error(path + " is not a Nim tablebase");
+	if (header.version != nimTablebaseVersion)
+		throw std::runtime_error(path + ": unsupported tablebase version " + std::to_string(header.version));
+	if (header.heapCount == 0 || header.heapCount > maxHeapCount)
+		throw std::runtime_error(path + ": bad heap count");
+	if (header.maxHeap > maxStones)
+		throw std::runtime_error(path + ": bad heap size");
+	heaps = header.heapCount;
+	maxHeap = header.maxHeap;
+	misere = (header.flags & nimTablebaseMisere) != 0;
+	init();
+	if (header.entryBits != entryBits || header.entryCount != entryCount)
+		throw std::runtime_error(path + ": header does not match its size");
+
+	// The table is only allocated once the file is known to hold it
+	unsigned long long bytes = (entryCount * entryBits + 63) / 64 * sizeof(uint64_t);
+	std::streamoff start = in.tellg();
+	in.seekg(0, std::ios::end);
+	if (!in || (unsigned long long)(in.tellg() - start) < bytes)
+		throw std::runtime_error(path + ": truncated tablebase");
+	in.seekg(start);
+	words.assign((size_t)(bytes / sizeof(uint64_t)), 0);
+	if (!in.read((char*)words.data(), (std::streamsize)memoryBytes()))
+		throw std::runtime_error(path + ": truncated tablebase");
+}
+
+// Binomials for ranking, and the entry width from the longest possible game. The
+// heap count and size are bounded, only the entry count can overflow.
+void NimTablebase::init() {
+	unsigned int longest = heaps * maxHeap;
+
+	binomial.assign(maxHeap + heaps + 1, std::vector<unsigned long long>(heaps + 1, 0));
+	for (unsigned int n = 0; n < binomial.size(); n++) {
+		binomial[n][0] = 1;
+		for (unsigned int k = 1; k <= heaps && k <= n; k++) {
+			binomial[n][k] = binomial[n - 1][k - 1] + (k < n ? binomial[n - 1][k] : 0);
+			if (binomial[n][k] < binomial[n - 1][k - 1])
+				throw std::length_error("Tablebase of " + std::to_string(heaps) + " heaps of " + std::to_string(maxHeap) + " is too large");
+		}
+	}
+	entryCount = binomial[maxHeap + heaps][heaps];
+	entryBits = 1;
+	while (longest > 0) {
+		entryBits++;
+		longest >>= 1;
+	}
+	if (entryCount > (~0ULL - 63) / entryBits)
+		throw std::length_error("Tablebase of " + std::to_string(heaps) + " heaps of " + std::to_string(maxHeap) + " is too large");
+}
+
+// Every move lowers one heap, which lowers the rank of the sorted position, so
+// solving in rank order walks back from the empty board with every successor
+// already known
+void NimTablebase::generate() {
+	unsigned int position[maxHeapCount];
+	unsigned int next[maxHeapCount];
+
+	for (unsigned long long r = 0; r < entryCount; r++) {
+		bool win = false;
+		unsigned int winDistance = ~0u;
+		unsigned int lossDistance = 0;
+		bool terminal = true;
+
+		unrank(r, position);
+		for (unsigned int h = 0; h < heaps; h++) {
+			if (position[h] == 0 || (h + 1 < heaps && position[h + 1] == position[h]))
+				continue;						// empty, or the same as the next heap
+			terminal = false;
+			for (unsigned int take = 1; take <= position[h]; take++) {
+				unsigned int i = h;
+				std::memcpy(next, position, heaps * sizeof(unsigned int));
+				for (; i > 0 && next[i - 1] > position[h] - take; i--)
+					next[i] = next[i - 1];
+				next[i] = position[h] - take;
+
+				unsigned int e = entry(rank(next));
+				unsigned int distance = e >> 1;
+				if ((e & 1) == 0) {
+					win = true;
+					winDistance = distance < winDistance ? distance : winDistance;
+				}
+				else {
+					lossDistance = distance > lossDistance ? distance : lossDistance;
+				}
+			}
+		}
+
+		// With no stones left the previous player took the last one
+		if (terminal)
+			setEntry(r, misere ? 1 : 0);
+		else
+			setEntry(r, win ? ((winDistance + 1) << 1) | 1 : (lossDistance + 1) << 1);
+	}
+}
+
+void NimTablebase::save(const std::string& path) const {
+	NimTablebaseHeader header = {};
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+	if (!out)
+		throw std::runtime_error("Cannot create tablebase " + path);
+	std::memcpy(header.magic, "ABPN", 4);
+	header.version = nimTablebaseVersion;
+	header.heapCount = heaps;
+	header.maxHeap = maxHeap;
+	header.flags = misere ? nimTablebaseMisere : 0;
+	header.entryBits = entryBits;
+	header.entryCount = entryCount;
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)words.data(), (std::streamsize)memoryBytes());
+	if (!out)
+		throw std::runtime_error("Error writing tablebase " + path);
+}
+
+bool NimTablebase::probe(const int* position, unsigned int count, bool& win, unsigned int& distance) const {
+	unsigned int sorted[maxHeapCount] = {};
+	unsigned int used = 0;
+
+	// Non-empty heaps are insertion sorted into the top of the array
+	for (unsigned int h = 0; h < count; h++) {
+		if (position[h] == 0)
+			continue;
+		if (used == heaps || (unsigned int)position[h] > maxHeap)
+			return false;
+		unsigned int i = heaps - ++used;
+		for (; i + 1 < heaps && sorted[i + 1] < (unsigned int)position[h]; i++)
+			sorted[i] = sorted[i + 1];
+		sorted[i] = (unsigned int)position[h];
+	}
+
+	unsigned int e = entry(rank(sorted));
+	win = (e & 1) != 0;
+	distance = e >> 1;
+	return true;
+}
+
+// Sorted heaps a0 <= a1 <= ... map to the combination a0 < a1 + 1 < a2 + 2 ...
+unsigned long long NimTablebase::rank(const unsigned int* sorted) const {
+	unsigned long long r = 0;
+
+	for (unsigned int i = 0; i < heaps; i++)
+		r += binomial[sorted[i] + i][i + 1];
+	return r;
+}
+
+void NimTablebase::unrank(unsigned long long r, unsigned int* sorted) const {
+	unsigned int b = maxHeap + heaps - 1;
+
+	for (unsigned int i = heaps; i-- > 0;) {
+		while (binomial[b][i + 1] > r)
+			b--;
+		r -= binomial[b][i + 1];
+		sorted[i] = b - i;
+	}
+}
+
+unsigned int NimTablebase::entry(unsigned long long index) const {
+	unsigned long long bit = index * entryBits;
+	unsigned int offset = (unsigned int)(bit & 63);
+	uint64_t value = words[(size_t)(bit >> 6)] >> offset;
+
+	if (offset + entryBits > 64)
+		value |= words[(size_t)(bit >> 6) + 1] << (64 - offset);
+	return (unsigned int)(value & ((1ULL << entryBits) - 1));
+}
+
+void NimTablebase::setEntry(unsigned long long index, unsigned int value) {
+	unsigned long long bit = index * entryBits;
+	unsigned int offset = (unsigned int)(bit & 63);
+	uint64_t mask = (1ULL << entryBits) - 1;
+
+	words[(size_t)(bit >> 6)] = (words[(size_t)(bit >> 6)] & ~(mask << offset)) | ((uint64_t)value << offset);
+	if (offset + entryBits > 64)
+		words[(size_t)(bit >> 6) + 1] = (words[(size_t)(bit >> 6) + 1] & ~(mask >> (64 - offset))) | ((uint64_t)value >> (64 - offset));
+}
+#pragma endregion
@@ -0,0 +1,60 @@
+#pragma once
+/*************************************************************************************/
+// Nim endgame tablebase class header
+// Holds the result of every position with up to heapCount heaps of at most maxHeap
+// stones. Heap order does not matter in Nim, so a position is sorted and ranked in
+// the combinatorial number system, C(maxHeap + heapCount, heapCount) entries in all.
+// Entries are bit packed: the low bit is set when the side to move wins, the rest
+// is the distance in plies to the end of the game with best play.
+// File layout: NimTablebaseHeader, then the packed 64 bit words.
+/*************************************************************************************/
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct NimTablebaseHeader {
+	char magic[4];							// "ABPN"
+	uint32_t version;
+	uint32_t heapCount;
+	uint32_t maxHeap;
+	uint32_t flags;							// misere
+	uint32_t entryBits;
+	uint64_t entryCount;
+};
+
+const uint32_t nimTablebaseVersion = 1;
+const uint32_t nimTablebaseMisere = 1;
+
+class NimTablebase {
+public:
+	static const unsigned int maxHeapCount = 16;
+	static const unsigned int maxStones = 255;		// per heap, as in NimState
+
+	NimTablebase(unsigned int heapCount, unsigned int maxHeap, bool misere);
+	explicit NimTablebase(const std::string&);		// load a generated file
+
+	void generate();
+	void save(const std::string&) const;
+	// Heaps in any order, false when the position is outside the table
+	bool probe(const int* heaps, unsigned int count, bool& win, unsigned int& distance) const;
+
+	bool isMisere() const { return misere; };
+	unsigned int heapCount() const { return heaps; };
+	unsigned int maxHeapSize() const { return maxHeap; };
+	unsigned long long size() const { return entryCount; };
+	unsigned long long memoryBytes() const { return words.size() * sizeof(uint64_t); };
+private:
+	unsigned int heaps;
+	unsigned int maxHeap;
+	bool misere;
+	unsigned int entryBits = 0;
+	unsigned long long entryCount = 0;
+	std::vector<uint64_t> words;
+	std::vector<std::vector<unsigned long long>> binomial;
+
+	void init();
+	unsigned long long rank(const unsigned int*) const;
+	void unrank(unsigned long long, unsigned int*) const;
+	unsigned int entry(unsigned long long) const;
+	void setEntry(unsigned long long, unsigned int);
+};
@@ -0,0 +1,149 @@
+/*************************************************************************************/
+// Principal Variation Search (NegaScout) class
+/*************************************************************************************/
+#include <algorithm>
+#include <cstdint>
+
+#include "PVSAlphaBeta.h"
+
+#pragma region PVSAlphaBeta
+// Scores are kept in long long internally so negating int bounds cannot overflow.
+// An empty window has no value inside it, like the fail-hard engine return its bound.
+int PVSAlphaBeta::search(Node* node, int depth, int alpha, int beta, bool isMax) {
+	stats.setRoot(depth);
+	rootChoice = -1;
+	rootDepth = depth;
+	if (alpha >= beta)
+		return isMax ? alpha : beta;
+	long long score = isMax ? pvs(node, depth, alpha, beta, 1) : -pvs(node, depth, -(long long)beta, -(long long)alpha, -1);
+	return (int)score;
+}
+
+int PVSAlphaBeta::search(GameState& state, int depth, int alpha, int beta, bool isMax) {
+	stats.setRoot(depth);
+	rootChoice = -1;
+	rootDepth = depth;
+	if (alpha >= beta)
+		return isMax ? alpha : beta;
+	long long score = isMax ? pvs(state, depth, alpha, beta, 1) : -pvs(state, depth, -(long long)beta, -(long long)alpha, -1);
+	return (int)score;
+}
+
+int PVSAlphaBeta::staticEvaluator() {
+	return 0;
+}
+
+// color is +1 when max is to move, node values are from max's point of view
+long long PVSAlphaBeta::pvs(Node* node, int depth, long long alpha, long long beta, int color) {
+	long long bestValue = -infinity;
+	long long childValue = 0;
+
+	if (limitReached(nodeCount))
+		return alpha;
+	nodeCount++;
+	stats.node(depth);
+	if ((depth <= 0) || (node->children.size() == 0)) {
+		stats.leaf(depth);
+		return color * (long long)node->value;
+	}
+
+	std::vector<Node*>* children = &node->children;
+	if (orderer != nullptr) {
+		if (nodeOrder.size() <= (size_t)depth)
+			nodeOrder.resize(depth + 1);
+		nodeOrder[depth] = node->children;
+		children = &nodeOrder[depth];
+		orderer->order(*children, rootDepth - depth, 0, [color](Node* n) { return TranspositionTable::Hash(n->name, color < 0); });
+	}
+
+	for (unsigned int i = 0; i < children->size(); i++) {
+		Node* n = (*children)[i];
+		if (i == 0) {
+			childValue = -pvs(n, depth - 1, -beta, -alpha, -color);
+		}
+		else {
+			// Null window to prove the child is no better, full window if it is
+			childValue = -pvs(n, depth - 1, -alpha - 1, -alpha, -color);
+			if (alpha < childValue && childValue < beta) {
+				researches++;
+				childValue = -pvs(n, depth - 1, -beta, -alpha, -color);
+			}
+		}
+		if (aborted)
+			return alpha;				// partial, no root choice, ordering or value is recorded
+		if (depth == rootDepth && childValue > alpha)
+			rootChoice = (int)(std::find(node->children.begin(), node->children.end(), n) - node->children.begin());
+		bestValue = childValue > bestValue ? childValue : bestValue;
+		alpha = bestValue > alpha ? bestValue : alpha;
+		if (alpha >= beta) {
+			trace.cutoff((unsigned long long)(uintptr_t)n, n->name.c_str(), depth, (int)alpha, (int)beta);
+			stats.cutoff(depth, color > 0, i == 0);
+			if (orderer != nullptr)
+				orderer->cutoff(TranspositionTable::Hash(n->name, color < 0), rootDepth - depth, depth, i == 0);
+			break;
+		}
+	}
+
+	// Save the value found, from max's point of view
+	node->value = (int)(color * bestValue);
+	return bestValue;
+}
+
+long long PVSAlphaBeta::pvs(GameState& state, int depth, long long alpha, long long beta, int color) {
+	long long bestValue = -infinity;
+	long long childValue = 0;
+	int exact = 0;
+
+	if (limitReached(nodeCount))
+		return alpha;
+	nodeCount++;
+	stats.node(depth);
+	if (state.probe(exact)) {
+		stats.leaf(depth);
+		return color * (long long)exact;
+	}
+	if ((depth <= 0) || state.isTerminal()) {
+		stats.leaf(depth);
+		return color * (long long)state.evaluate();
+	}
+
+	if (moveStack.size() <= (size_t)depth)
+		moveStack.resize(depth + 1);
+	std::vector<Move>& moves = moveStack[depth];
+	state.generateMoves(moves);
+	if (depth == rootDepth)
+		rootMoves = moves;				// generation order, for the root choice
+	if (orderer != nullptr)
+		orderer->order(moves, rootDepth - depth, 0, [](Move m) { return (unsigned long long)m + 1; });
+
+	for (unsigned int i = 0; i < moves.size(); i++) {
+		state.apply(moves[i]);
+		if (i == 0) {
+			childValue = -pvs(state, depth - 1, -beta, -alpha, -color);
+		}
+		else {
+			// Null window to prove the move is no better, full window if it is
+			childValue = -pvs(state, depth - 1, -alpha - 1, -alpha, -color);
+			if (alpha < childValue && childValue < beta) {
+				researches++;
+				childValue = -pvs(state, depth - 1, -beta, -alpha, -color);
+			}
+		}
+		state.undo(moves[i]);
+		if (aborted)
+			return alpha;
+		if (depth == rootDepth && childValue > alpha)
+			rootChoice = (int)(std::find(rootMoves.begin(), rootMoves.end(), moves[i]) - rootMoves.begin());
+		bestValue = childValue > bestValue ? childValue : bestValue;
+		alpha = bestValue > alpha ? bestValue : alpha;
+		if (alpha >= beta) {
+			trace.cutoff(SearchTrace::enabled ? state.key() : 0, nullptr, depth, (int)alpha, (int)beta);
+			stats.cutoff(depth, color > 0, i == 0);
+			if (orderer != nullptr)
+				orderer->cutoff((unsigned long long)moves[i] + 1, rootDepth - depth, depth, i == 0);
+			break;
+		}
+	}
+	return bestValue;
+}
+#pragma endregion
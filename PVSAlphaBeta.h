@@ -0,0 +1,28 @@
+#pragma once
+/*************************************************************************************/
+// Principal Variation Search (NegaScout) class header
+// Negamax formulation: every node maximises the score for the side to move, so
+// there is a single branch. The first child gets the full window, the others a
+// null window, re-searched when they fail high. Return values are fail-soft.
+/*************************************************************************************/
+#include <vector>
+
+#include "AlphaBeta.h"
+
+class PVSAlphaBeta : public AlphaBeta {
+public:
+	int search(Node*, int, int, int, bool) override;
+	int search(GameState&, int, int, int, bool) override;
+	int staticEvaluator() override;
+	int researchCount() { return researches; };
+private:
+	static const long long infinity = 1LL << 40;		// beyond any int score
+	int researches = 0;
+	int rootDepth = 0;								// of the last search, depth only falls below the root
+	std::vector<Move> rootMoves;
+	std::vector<std::vector<Node*>> nodeOrder;		// ordered children, indexed by depth
+	std::vector<std::vector<Move>> moveStack;		// generated moves, indexed by depth
+
+	long long pvs(Node*, int, long long, long long, int);
+	long long pvs(GameState&, int, long long, long long, int);
+};
@@ -0,0 +1,234 @@
+/*************************************************************************************/
+// Parallel AlphaBeta class
+/*************************************************************************************/
+#include <cstdint>
+
+#include "ParallelAlphaBeta.h"
+
+#pragma region ParallelAlphaBeta
+ParallelAlphaBeta::ParallelAlphaBeta(unsigned int threads) : ownPool(new ThreadPool(threads)), pool(*ownPool), counters(pool.size() + 1) {}
+
+ParallelAlphaBeta::ParallelAlphaBeta(ThreadPool& shared) : pool(shared), counters(pool.size() + 1) {}
+
+bool ParallelAlphaBeta::SplitPoint::isCancelled() const {
+	for (const SplitPoint* sp = this; sp != nullptr; sp = sp->parent) {
+		if (sp->cancelled.load(std::memory_order_relaxed))
+			return true;
+	}
+	return false;
+}
+
+int ParallelAlphaBeta::search(Node* node, int depth, int alpha, int beta, bool isMax) {
+	rootChoice = -1;
+	rootDepth = depth;
+	for (Counter& c : counters)
+		c.stats.setRoot(depth);
+	int value = searchNode(node, depth, alpha, beta, isMax, nullptr);
+	collectCounts();
+	return value;
+}
+
+int ParallelAlphaBeta::search(GameState& state, int depth, int alpha, int beta, bool isMax) {
+	rootChoice = -1;
+	rootDepth = depth;
+	for (Counter& c : counters)
+		c.stats.setRoot(depth);
+	int value = searchState(state, depth, alpha, beta, isMax, nullptr);
+	collectCounts();
+	return value;
+}
+
+int ParallelAlphaBeta::staticEvaluator() {
+	return 0;
+}
+
+ParallelAlphaBeta::Counter& ParallelAlphaBeta::threadCounter() {
+	int index = pool.workerIndex();
+	return counters[index >= 0 ? index : pool.size()];
+}
+
+// The node limit of setSearchLimits applies per thread here
+bool ParallelAlphaBeta::countNode(int depth) {
+	Counter& c = threadCounter();
+	c.stats.node(depth);
+	return limitReached(++c.nodes);
+}
+
+// Siblings finish in any order: a better child takes the root, an equal one only
+// when it is lower and its value is exact, strictly inside the window it had
+void ParallelAlphaBeta::chooseRoot(int index, int value, int bound, int best, bool isMax) {
+	bool better = isMax ? value > best : value < best;
+	bool exactTie = value == best && index < rootChoice && (isMax ? value > bound : value < bound);
+	if (better || exactTie)
+		rootChoice = index;
+}
+
+void ParallelAlphaBeta::collectCounts() {
+	for (Counter& c : counters) {
+		nodeCount += c.nodes;
+		stats.merge(c.stats);
+		c.nodes = 0;
+		c.stats.clear();
+	}
+}
+
+int ParallelAlphaBeta::searchNode(Node* node, int depth, int alpha, int beta, bool isMax, SplitPoint* parent) {
+	size_t count = node->children.size();
+	int bestValue = isMax ? alpha : beta;
+	size_t i = 0;
+
+	if (countNode(depth) || (parent != nullptr && parent->isCancelled()))
+		return bestValue;
+	if ((depth <= 0) || (count == 0)) {
+		threadCounter().stats.leaf(depth);
+		return node->value;
+	}
+
+	// Eldest brother first, then the rest serially near the leaves
+	for (; i < count; i++) {
+		if (i == 1 && depth >= minSplitDepth && count > 2)
+			break;
+		int childValue = isMax ?
+			searchNode(node->children[i], depth - 1, bestValue, beta, false, parent) :
+			searchNode(node->children[i], depth - 1, alpha, bestValue, true, parent);
+		if (aborted)
+			return bestValue;		// partial, no root choice or value is recorded
+		if (depth == rootDepth && (isMax ? childValue > bestValue : childValue < bestValue))
+			rootChoice = (int)i;
+		bestValue = isMax ? (childValue > bestValue ? childValue : bestValue) : (childValue < bestValue ? childValue : bestValue);
+		if (isMax ? (beta <= bestValue) : (bestValue <= alpha)) {
+			trace.cutoff((unsigned long long)(uintptr_t)node->children[i], node->children[i]->name.c_str(), depth, alpha, beta);
+			threadCounter().stats.cutoff(depth, isMax, i == 0);
+			i = count;
+			break;
+		}
+	}
+
+	// Young brothers in parallel
+	if (i < count) {
+		SplitPoint sp;
+		TaskGroup group;
+		const int window = bestValue;
+
+		sp.parent = parent;
+		sp.bestValue = bestValue;
+		for (; i < count; i++) {
+			Node* child = node->children[i];
+			pool.run(group, [this, &sp, child, i, depth, alpha, beta, isMax, window]() {
+				int bound = window;
+				if (sp.isCancelled())
+					return;
+				if (!deterministic) {
+					std::lock_guard<std::mutex> guard(sp.lock);
+					bound = sp.bestValue;
+				}
+				int childValue = isMax ?
+					searchNode(child, depth - 1, bound, beta, false, &sp) :
+					searchNode(child, depth - 1, alpha, bound, true, &sp);
+				if (sp.isCancelled() || aborted)
+					return;
+				std::lock_guard<std::mutex> guard(sp.lock);
+				if (depth == rootDepth)
+					chooseRoot((int)i, childValue, bound, sp.bestValue, isMax);
+				sp.bestValue = isMax ? (childValue > sp.bestValue ? childValue : sp.bestValue) : (childValue < sp.bestValue ? childValue : sp.bestValue);
+				if (!deterministic && (isMax ? (beta <= sp.bestValue) : (sp.bestValue <= alpha))) {
+					trace.cutoff((unsigned long long)(uintptr_t)child, child->name.c_str(), depth, alpha, beta);
+					threadCounter().stats.cutoff(depth, isMax, false);
+					sp.cancelled = true;
+				}
+			});
+		}
+		pool.wait(group);
+		bestValue = sp.bestValue;
+		if (aborted)
+			return bestValue;
+	}
+
+	// Save the best child value found
+	int bestChildValue = node->children[0]->value;
+	for (Node* n : node->children)
+		bestChildValue = isMax ? (n->value > bestChildValue ? n->value : bestChildValue) : (n->value < bestChildValue ? n->value : bestChildValue);
+	node->value = bestChildValue;
+	return bestValue;
+}
+
+int ParallelAlphaBeta::searchState(GameState& state, int depth, int alpha, int beta, bool isMax, SplitPoint* parent) {
+	std::vector<Move> moves;
+	int bestValue = isMax ? alpha : beta;
+	size_t i = 0;
+
+	if (countNode(depth) || (parent != nullptr && parent->isCancelled()))
+		return bestValue;
+	if (state.probe(bestValue)) {
+		threadCounter().stats.leaf(depth);
+		return bestValue;
+	}
+	if ((depth <= 0) || state.isTerminal()) {
+		threadCounter().stats.leaf(depth);
+		return state.evaluate();
+	}
+	state.generateMoves(moves);
+
+	// Eldest brother first, then the rest serially near the leaves
+	for (; i < moves.size(); i++) {
+		if (i == 1 && depth >= minSplitDepth && moves.size() > 2)
+			break;
+		state.apply(moves[i]);
+		int childValue = isMax ?
+			searchState(state, depth - 1, bestValue, beta, false, parent) :
+			searchState(state, depth - 1, alpha, bestValue, true, parent);
+		state.undo(moves[i]);
+		if (aborted)
+			return bestValue;
+		if (depth == rootDepth && (isMax ? childValue > bestValue : childValue < bestValue))
+			rootChoice = (int)i;
+		bestValue = isMax ? (childValue > bestValue ? childValue : bestValue) : (childValue < bestValue ? childValue : bestValue);
+		if (isMax ? (beta <= bestValue) : (bestValue <= alpha)) {
+			trace.cutoff(SearchTrace::enabled ? state.key() : 0, nullptr, depth, alpha, beta);
+			threadCounter().stats.cutoff(depth, isMax, i == 0);
+			i = moves.size();
+			break;
+		}
+	}
+
+	// Young brothers in parallel, each on its own copy of the state
+	if (i < moves.size()) {
+		SplitPoint sp;
+		TaskGroup group;
+		const int window = bestValue;
+
+		sp.parent = parent;
+		sp.bestValue = bestValue;
+		for (; i < moves.size(); i++) {
+			std::shared_ptr<GameState> child(state.clone());
+			child->apply(moves[i]);
+			pool.run(group, [this, &sp, child, i, depth, alpha, beta, isMax, window]() {
+				int bound = window;
+				if (sp.isCancelled())
+					return;
+				if (!deterministic) {
+					std::lock_guard<std::mutex> guard(sp.lock);
+					bound = sp.bestValue;
+				}
+				int childValue = isMax ?
+					searchState(*child, depth - 1, bound, beta, false, &sp) :
+					searchState(*child, depth - 1, alpha, bound, true, &sp);
+				if (sp.isCancelled() || aborted)
+					return;
+				std::lock_guard<std::mutex> guard(sp.lock);
+				if (depth == rootDepth)
+					chooseRoot((int)i, childValue, bound, sp.bestValue, isMax);
+				sp.bestValue = isMax ? (childValue > sp.bestValue ? childValue : sp.bestValue) : (childValue < sp.bestValue ? childValue : sp.bestValue);
+				if (!deterministic && (isMax ? (beta <= sp.bestValue) : (sp.bestValue <= alpha))) {
+					trace.cutoff(SearchTrace::enabled ? child->key() : 0, nullptr, depth, alpha, beta);
+					threadCounter().stats.cutoff(depth, isMax, false);
+					sp.cancelled = true;
+				}
+			});
+		}
+		pool.wait(group);
+		bestValue = sp.bestValue;
+	}
+	return bestValue;
+}
+#pragma endregion
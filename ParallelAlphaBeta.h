@@ -0,0 +1,55 @@
+#pragma once
+/*************************************************************************************/
+// Parallel AlphaBeta class header
+// Young Brothers Wait: the eldest child of a node is searched serially, the younger
+// siblings are then spread over a work stealing pool. A cutoff cancels the
+// siblings still in flight. Node counts and statistics are kept per thread and
+// summed.
+/*************************************************************************************/
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AlphaBeta.h"
+#include "ThreadPool.h"
+
+class ParallelAlphaBeta : public AlphaBeta {
+public:
+	explicit ParallelAlphaBeta(unsigned int threads = std::thread::hardware_concurrency());
+	explicit ParallelAlphaBeta(ThreadPool&);		// splits on a pool shared with other work
+	int search(Node*, int, int, int, bool) override;
+	int search(GameState&, int, int, int, bool) override;
+	int staticEvaluator() override;
+	// Deterministic mode: no shared bounds or cancellation between siblings, so
+	// counts and results do not depend on thread timing
+	void setDeterministic(bool d) { deterministic = d; };
+	void setMinSplitDepth(int d) { minSplitDepth = d; };
+	unsigned int threadCount() const { return pool.size(); };
+private:
+	struct SplitPoint {
+		SplitPoint* parent = nullptr;
+		std::atomic<bool> cancelled{ false };
+		std::mutex lock;
+		int bestValue = 0;
+		bool isCancelled() const;
+	};
+	struct alignas(64) Counter {
+		long long nodes = 0;
+		SearchStats stats;
+	};
+
+	std::unique_ptr<ThreadPool> ownPool;
+	ThreadPool& pool;
+	std::vector<Counter> counters;				// one per worker, plus the calling thread
+	bool deterministic = false;
+	int minSplitDepth = 2;
+	int rootDepth = 0;							// of the last search, depth only falls below the root
+
+	int searchNode(Node*, int, int, int, bool, SplitPoint*);
+	int searchState(GameState&, int, int, int, bool, SplitPoint*);
+	Counter& threadCounter();
+	bool countNode(int);
+	void chooseRoot(int, int, int, int, bool);
+	void collectCounts();
+};
@@ -0,0 +1,128 @@
+/*************************************************************************************/
+// Hardware performance counters class
+/*************************************************************************************/
+#include <cerrno>
+#include <cstring>
+
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+	int openEvent(unsigned int type, unsigned long long config) {
+		struct perf_event_attr attr;
+
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);	// this thread, any cpu
+	}
+
+	unsigned long long cacheMiss(unsigned long long cache) {
+		return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	}
+}
+#endif
+
+#pragma region PerfCounters
+PerfCounters::PerfCounters() {
+	for (int& fd : fds)
+		fd = -1;
+#ifdef __linux__
+	fds[PerfCycles] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	if (fds[PerfCycles] < 0) {
+		error = std::string("perf_event_open failed: ") + std::strerror(errno);
+		return;
+	}
+	fds[PerfInstructions] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	fds[PerfL1DMisses] = openEvent(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D));
+	fds[PerfLLCMisses] = openEvent(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL));
+	fds[PerfBranchMisses] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#else
+	error = "hardware counters need Linux perf_event_open";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+	for (int fd : fds) {
+		if (fd >= 0)
+			close(fd);
+	}
+#endif
+}
+
+bool PerfCounters::Available() const {
+	return fds[PerfCycles] >= 0;
+}
+
+void PerfCounters::Start() {
+#ifdef __linux__
+	for (int fd : fds) {
+		if (fd >= 0) {
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+}
+
+// A multiplexed counter only ran part of the time, its count is scaled up
+void PerfCounters::Stop(const std::string& phase) {
+	PerfTotals& totals = phases[phase];
+
+#ifdef __linux__
+	for (int fd : fds) {
+		if (fd >= 0)
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+	}
+	for (int e = 0; e < PerfEventCount; e++) {
+		unsigned long long value[3] = {};		// count, time enabled, time running
+		if (fds[e] >= 0 && read(fds[e], value, sizeof(value)) == (ssize_t)sizeof(value) && value[2] > 0)
+			totals.counts[e] += value[2] < value[1] ? (unsigned long long)((double)value[0] * value[1] / value[2]) : value[0];
+	}
+#endif
+	if (totals.runs++ == 0)
+		order.push_back(phase);
+}
+
+void PerfCounters::Clear() {
+	order.clear();
+	phases.clear();
+}
+
+PerfTotals PerfCounters::Totals(const std::string& phase) const {
+	std::map<std::string, PerfTotals>::const_iterator p = phases.find(phase);
+	return p == phases.end() ? PerfTotals() : p->second;
+}
+
+void PerfCounters::WriteJson(std::ostream& out, long long nodes) const {
+	for (const std::string& phase : order) {
+		const PerfTotals& t = phases.at(phase);
+		double perNode = nodes > 0 ? 1.0 / ((double)nodes * t.runs) : 0.0;
+
+		out << "{\"phase\":\"" << phase << "\",\"runs\":" << t.runs;
+		for (int e = 0; e < PerfEventCount; e++) {
+			if (Counting((PerfEvent)e))
+				out << ",\"" << EventName((PerfEvent)e) << "\":" << t.counts[e] << ",\"" << EventName((PerfEvent)e) << "_per_node\":" << t.counts[e] * perNode;
+		}
+		if (Counting(PerfInstructions) && t.counts[PerfCycles] > 0)
+			out << ",\"ipc\":" << (double)t.counts[PerfInstructions] / t.counts[PerfCycles];
+		out << "}" << std::endl;
+	}
+}
+
+const char* PerfCounters::EventName(PerfEvent e) {
+	static const char* names[PerfEventCount] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+	return names[e];
+}
+#pragma endregion
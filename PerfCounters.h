@@ -0,0 +1,55 @@
+#pragma once
+/*************************************************************************************/
+// Hardware performance counters class header
+// Counts cycles, instructions, L1 data and last level cache misses and branch
+// misses of the calling thread with perf_event_open, per named phase. Linux
+// only: elsewhere, or when the kernel refuses (perf_event_paranoid, a VM without
+// a PMU), Available() is false and Error() says why. An event the CPU lacks is
+// skipped on its own. Worker threads of the parallel engines are not counted.
+/*************************************************************************************/
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum PerfEvent { PerfCycles, PerfInstructions, PerfL1DMisses, PerfLLCMisses, PerfBranchMisses, PerfEventCount };
+
+struct PerfTotals {
+	unsigned long long runs = 0;
+	unsigned long long counts[PerfEventCount] = {};
+};
+
+class PerfCounters {
+public:
+	// Counts its own lifetime into a phase
+	class Scope {
+	public:
+		Scope(PerfCounters& c, const std::string& p) : counters(c), phase(p) { counters.Start(); };
+		~Scope() { counters.Stop(phase); };
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		PerfCounters& counters;
+		std::string phase;
+	};
+
+	PerfCounters();
+	~PerfCounters();
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+	bool Available() const;
+	bool Counting(PerfEvent e) const { return fds[e] >= 0; };
+	const std::string& Error() const { return error; };
+	void Start();
+	void Stop(const std::string&);					// adds the counts since Start to a phase
+	void Clear();
+	PerfTotals Totals(const std::string&) const;
+	// One object per phase, every count also divided by the nodes searched per run
+	void WriteJson(std::ostream&, long long nodes) const;
+	static const char* EventName(PerfEvent);
+private:
+	int fds[PerfEventCount];
+	std::string error;
+	std::vector<std::string> order;					// phases in first recorded order
+	std::map<std::string, PerfTotals> phases;
+};
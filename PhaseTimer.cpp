@@ -0,0 +1,103 @@
+/*************************************************************************************/
+// Phase Timer class
+/*************************************************************************************/
+#include <algorithm>
+#include <iomanip>
+
+#include "PhaseTimer.h"
+
+namespace {
+	// Nearest rank percentile of sorted samples
+	unsigned long long percentile(const std::vector<unsigned long long>& sorted, unsigned int p) {
+		size_t rank = (sorted.size() * p + 99) / 100;
+		return sorted[rank > 0 ? rank - 1 : 0];
+	}
+
+	unsigned int log2Bucket(unsigned long long nanos) {
+		unsigned int b = 0;
+		while (nanos > 1) {
+			nanos >>= 1;
+			b++;
+		}
+		return b;
+	}
+}
+
+#pragma region PhaseTimer
+void PhaseTimer::Record(const std::string& phase, unsigned long long nanos) {
+	std::lock_guard<std::mutex> guard(lock);
+	std::vector<unsigned long long>& s = samples[phase];
+
+	if (s.empty())
+		order.push_back(phase);
+	s.push_back(nanos);
+}
+
+void PhaseTimer::Clear() {
+	std::lock_guard<std::mutex> guard(lock);
+	order.clear();
+	samples.clear();
+}
+
+std::vector<std::string> PhaseTimer::Phases() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return order;
+}
+
+PhaseSummary PhaseTimer::Summary(const std::string& phase) const {
+	PhaseSummary summary;
+	std::vector<unsigned long long> sorted;
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		auto found = samples.find(phase);
+		if (found != samples.end())
+			sorted = found->second;
+	}
+	summary.phase = phase;
+	if (sorted.empty())
+		return summary;
+	std::sort(sorted.begin(), sorted.end());
+	summary.samples = sorted.size();
+	summary.minNanos = sorted.front();
+	summary.p50Nanos = percentile(sorted, 50);
+	summary.p99Nanos = percentile(sorted, 99);
+	summary.maxNanos = sorted.back();
+	for (unsigned long long n : sorted)
+		summary.meanNanos += (double)n;
+	summary.meanNanos /= sorted.size();
+	return summary;
+}
+
+void PhaseTimer::WriteReport(std::ostream& out) const {
+	for (const std::string& phase : Phases()) {
+		PhaseSummary s = Summary(phase);
+		std::vector<unsigned long long> buckets;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			for (unsigned long long n : samples.at(phase)) {
+				unsigned int b = log2Bucket(n);
+				if (buckets.size() <= b)
+					buckets.resize(b + 1);
+				buckets[b]++;
+			}
+		}
+
+		out << phase << ": " << s.samples << " samples, p50 " << s.p50Nanos << "ns, p99 " << s.p99Nanos
+			<< "ns, max " << s.maxNanos << "ns" << std::endl;
+		for (unsigned int b = log2Bucket(s.minNanos); b < buckets.size(); b++) {
+			out << "\t< 2^" << std::setw(2) << std::left << b + 1 << "ns " << std::setw(8) << std::right << buckets[b] << " "
+				<< std::string((size_t)(40 * buckets[b] / s.samples), '#') << std::endl;
+		}
+	}
+}
+
+void PhaseTimer::WriteJson(std::ostream& out) const {
+	for (const std::string& phase : Phases()) {
+		PhaseSummary s = Summary(phase);
+		out << "{\"phase\":\"" << s.phase << "\",\"samples\":" << s.samples << ",\"min_ns\":" << s.minNanos
+			<< ",\"p50_ns\":" << s.p50Nanos << ",\"p99_ns\":" << s.p99Nanos << ",\"max_ns\":" << s.maxNanos
+			<< ",\"mean_ns\":" << (unsigned long long)s.meanNanos << "}" << std::endl;
+	}
+}
+#pragma endregion
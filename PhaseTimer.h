@@ -0,0 +1,50 @@
+#pragma once
+/*************************************************************************************/
+// Phase Timer class header
+// Collects repeated monotonic samples for named phases (build, search, teardown)
+// and reports their percentiles. Record may be called from any thread, the lock
+// is only taken once per sample so phases should not be finer than a search.
+/*************************************************************************************/
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct PhaseSummary {
+	std::string phase;
+	unsigned long long samples = 0;
+	unsigned long long minNanos = 0;
+	unsigned long long p50Nanos = 0;
+	unsigned long long p99Nanos = 0;
+	unsigned long long maxNanos = 0;
+	double meanNanos = 0.0;
+};
+
+class PhaseTimer {
+public:
+	// Times its own lifetime into a phase
+	class Scope {
+	public:
+		Scope(PhaseTimer& t, const std::string& p) : timer(t), phase(p), start(std::chrono::steady_clock::now()) {};
+		~Scope() { timer.Record(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()); };
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		PhaseTimer& timer;
+		std::string phase;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	void Record(const std::string&, unsigned long long nanos);
+	void Clear();
+	std::vector<std::string> Phases() const;
+	PhaseSummary Summary(const std::string&) const;
+	void WriteReport(std::ostream&) const;				// percentiles and a log2 histogram per phase
+	void WriteJson(std::ostream&) const;				// one object per phase
+private:
+	mutable std::mutex lock;
+	std::vector<std::string> order;						// phases in first recorded order
+	std::map<std::string, std::vector<unsigned long long>> samples;
+};
@@ -0,0 +1,36 @@
+#pragma once
+/*************************************************************************************/
+// Principal variation table
+// Triangular table indexed by remaining depth: the row of a node at depth d holds
+// its best line, at most d moves. When a child raises the node's bound the row
+// becomes that child followed by the child's own row, one level down. Rows keep
+// their capacity, so after the first search nothing is allocated.
+/*************************************************************************************/
+#include <vector>
+
+template <class MoveType>
+class PVTable {
+public:
+	// At node entry, so a child returning early never leaves a stale line. A
+	// search called below the horizon has no row.
+	void clear(int depth) {
+		if (depth < 0)
+			return;
+		if (lines.size() <= (size_t)depth)
+			lines.resize(depth + 1);
+		lines[depth].clear();
+	};
+	void update(int depth, MoveType move) {
+		std::vector<MoveType>& line = lines[depth];
+		const std::vector<MoveType>& child = lines[depth - 1];
+		line.clear();
+		line.push_back(move);
+		line.insert(line.end(), child.begin(), child.end());
+	};
+	const std::vector<MoveType>& line(int depth) const {
+		return (size_t)depth < lines.size() ? lines[depth] : empty;
+	};
+private:
+	std::vector<std::vector<MoveType>> lines;
+	std::vector<MoveType> empty;
+};
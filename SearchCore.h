@@ -0,0 +1,273 @@
+#pragma once
+/*************************************************************************************/
+// Templated search core, header only
+// The tree type, the evaluator and the side to move are compile time parameters,
+// so the evaluator is inlined, every ply gets its own comparison and there is no
+// virtual call or isMax branch in the recursion. The best child value is kept in
+// the same pass over the children. TemplateAlphaBeta wraps the core behind the
+// AlphaBeta interface.
+/*************************************************************************************/
+#include <vector>
+
+#include "AlphaBeta.h"
+#include "FlatTree.h"
+#include "GameState.h"
+#include "SearchStats.h"
+
+#pragma region TreeAccess
+// A tree access policy expands a node (returns its child count, 0 for a leaf),
+// enters and leaves its i-th child, reads a node value and stores a backed up one.
+class NodeTreeAccess {
+public:
+	typedef Node* Handle;
+	unsigned int expand(Handle n, int) { return (unsigned int)n->children.size(); };
+	Handle enter(Handle n, int, unsigned int i) { return n->children[i]; };
+	void leave(Handle, int, unsigned int) {};
+	int value(Handle n) const { return n->value; };
+	void store(Handle n, int v) { n->value = v; };
+};
+
+// Read only access: nothing is written, so any number of threads may search
+// the same tree at once
+class ConstNodeTreeAccess {
+public:
+	typedef const Node* Handle;
+	unsigned int expand(Handle n, int) { return (unsigned int)n->children.size(); };
+	Handle enter(Handle n, int, unsigned int i) { return n->children[i]; };
+	void leave(Handle, int, unsigned int) {};
+	int value(Handle n) const { return n->value; };
+	void store(Handle, int) {};
+};
+
+class FlatTreeAccess {
+public:
+	typedef unsigned int Handle;
+	explicit FlatTreeAccess(FlatTree& t) : tree(t) {};
+	unsigned int expand(Handle n, int) { return tree.childCount[n]; };
+	Handle enter(Handle n, int, unsigned int i) { return tree.firstChild[n] + i; };
+	void leave(Handle, int, unsigned int) {};
+	int value(Handle n) const { return tree.values[n]; };
+	void store(Handle n, int v) { tree.values[n] = v; };
+private:
+	FlatTree& tree;
+};
+
+class ConstFlatTreeAccess {
+public:
+	typedef unsigned int Handle;
+	explicit ConstFlatTreeAccess(const FlatTree& t) : tree(t) {};
+	unsigned int expand(Handle n, int) { return tree.childCount[n]; };
+	Handle enter(Handle n, int, unsigned int i) { return tree.firstChild[n] + i; };
+	void leave(Handle, int, unsigned int) {};
+	int value(Handle n) const { return tree.values[n]; };
+	void store(Handle, int) {};
+private:
+	const FlatTree& tree;
+};
+
+// Moves are generated into a stack indexed by the remaining depth
+class GameStateAccess {
+public:
+	typedef GameState* Handle;
+	unsigned int expand(Handle s, int depth) {
+		int exact = 0;
+		if (s->isTerminal() || s->probe(exact))
+			return 0;
+		if (moves.size() <= (size_t)depth)
+			moves.resize(depth + 1);
+		s->generateMoves(moves[depth]);
+		return (unsigned int)moves[depth].size();
+	};
+	Handle enter(Handle s, int depth, unsigned int i) { s->apply(moves[depth][i]); return s; };
+	void leave(Handle s, int depth, unsigned int i) { s->undo(moves[depth][i]); };
+	int value(Handle s) const { int exact = 0; return s->probe(exact) ? exact : s->evaluate(); };
+	void store(Handle, int) {};
+private:
+	std::vector<std::vector<Move>> moves;
+};
+
+// Default evaluator: the value held by the tree
+class TreeValueEvaluator {
+public:
+	template <class Tree>
+	int operator()(const Tree& tree, typename Tree::Handle h) const { return tree.value(h); };
+};
+
+// A limit policy is asked on entering every node whether the search must stop,
+// and after every child whether it has stopped. Unlimited searches compile the
+// checks away.
+class NoSearchLimit {
+public:
+	bool reached(long long) { return false; };
+	bool stopped() const { return false; };
+};
+#pragma endregion
+
+#pragma region SearchCore
+// Score and chosen root child of a search, ties go to the first child
+struct SearchResult {
+	int value = 0;
+	int bestIndex = -1;					// root child index, -1 for a leaf root or if none beat the window
+	long long nodes = 0;
+};
+
+template <class Tree, class Evaluator = TreeValueEvaluator, class Limit = NoSearchLimit>
+class SearchCore {
+public:
+	typedef typename Tree::Handle Handle;
+	long long nodes = 0;
+	SearchStats* stats = nullptr;					// optional, not owned
+
+	explicit SearchCore(Tree& t, Evaluator e = Evaluator(), Limit l = Limit()) : tree(t), evaluator(e), limit(l) {};
+
+	// Fail-hard alpha-beta, IsMax is the side to move at node. A stopped search
+	// returns at once, without storing, and its value is meaningless.
+	template <bool IsMax>
+	int search(Handle node, int depth, int alpha, int beta) {
+		int bestValue = IsMax ? alpha : beta;
+		int bestChildValue = 0;
+
+		if (limit.reached(nodes))
+			return bestValue;
+		unsigned int count = depth > 0 ? tree.expand(node, depth) : 0;
+		nodes++;
+		if (stats != nullptr)
+			stats->node(depth);
+		if (count == 0) {
+			if (stats != nullptr)
+				stats->leaf(depth);
+			return evaluator(tree, node);
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			Handle child = tree.enter(node, depth, i);
+			int childValue = IsMax ?
+				search<!IsMax>(child, depth - 1, bestValue, beta) :
+				search<!IsMax>(child, depth - 1, alpha, bestValue);
+			tree.leave(node, depth, i);
+			if (limit.stopped())
+				return bestValue;
+			if (i == 0 || (IsMax ? childValue > bestChildValue : childValue < bestChildValue))
+				bestChildValue = childValue;
+			if (IsMax ? childValue > bestValue : childValue < bestValue)
+				bestValue = childValue;
+			if (IsMax ? beta <= bestValue : bestValue <= alpha) {
+				if (stats != nullptr)
+					stats->cutoff(depth, IsMax, i == 0);
+				break;
+			}
+		}
+		tree.store(node, bestChildValue);
+		return bestValue;
+	};
+
+	int search(Handle node, int depth, int alpha, int beta, bool isMax) {
+		return isMax ? search<true>(node, depth, alpha, beta) : search<false>(node, depth, alpha, beta);
+	};
+
+	// As search, also reporting which root child was chosen. A stopped search
+	// reports the children finished so far.
+	SearchResult searchRoot(Handle root, int depth, int alpha, int beta, bool isMax) {
+		SearchResult result;
+		int bestChildValue = 0;
+
+		result.value = isMax ? alpha : beta;
+		if (limit.reached(nodes))
+			return result;
+		unsigned int count = depth > 0 ? tree.expand(root, depth) : 0;
+		nodes++;
+		if (stats != nullptr)
+			stats->node(depth);
+		if (count == 0) {
+			if (stats != nullptr)
+				stats->leaf(depth);
+			result.value = evaluator(tree, root);
+			result.nodes = nodes;
+			return result;
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			Handle child = tree.enter(root, depth, i);
+			int childValue = isMax ?
+				search<false>(child, depth - 1, result.value, beta) :
+				search<true>(child, depth - 1, alpha, result.value);
+			tree.leave(root, depth, i);
+			if (limit.stopped()) {
+				result.nodes = nodes;
+				return result;
+			}
+			if (i == 0 || (isMax ? childValue > bestChildValue : childValue < bestChildValue))
+				bestChildValue = childValue;
+			if (isMax ? childValue > result.value : childValue < result.value) {
+				result.value = childValue;
+				result.bestIndex = (int)i;
+			}
+			if (isMax ? beta <= result.value : result.value <= alpha) {
+				if (stats != nullptr)
+					stats->cutoff(depth, isMax, i == 0);
+				break;
+			}
+		}
+		tree.store(root, bestChildValue);
+		result.nodes = nodes;
+		return result;
+	};
+private:
+	Tree& tree;
+	Evaluator evaluator;
+	Limit limit;
+};
+#pragma endregion
+
+#pragma region SearchRoot
+// Root search returning its result explicitly. With a read only access policy
+// all state lives in this call, so it is reentrant.
+template <class Evaluator = TreeValueEvaluator, class Tree>
+SearchResult SearchRoot(Tree& tree, typename Tree::Handle root, int depth, int alpha, int beta, bool isMax, Evaluator evaluator = Evaluator()) {
+	SearchCore<Tree, Evaluator> core(tree, evaluator);
+	return core.searchRoot(root, depth, alpha, beta, isMax);
+}
+#pragma endregion
+
+#pragma region TemplateAlphaBeta
+// Thin virtual wrapper, the only indirect call is the one into search. Searches
+// with a budget or stop token run a second instantiation of the core checking
+// them, the unlimited one has no checks at all. No table or move ordering.
+template <class Evaluator = TreeValueEvaluator>
+class TemplateAlphaBeta : public AlphaBeta {
+public:
+	int search(Node* node, int depth, int alpha, int beta, bool isMax) override {
+		NodeTreeAccess access;
+		return hasLimits() ? run(access, node, depth, alpha, beta, isMax, EngineLimit(this)) : run(access, node, depth, alpha, beta, isMax, NoSearchLimit());
+	};
+	int search(GameState& state, int depth, int alpha, int beta, bool isMax) override {
+		return hasLimits() ? run(stateAccess, &state, depth, alpha, beta, isMax, EngineLimit(this)) : run(stateAccess, &state, depth, alpha, beta, isMax, NoSearchLimit());
+	};
+	int search(FlatTree& tree, unsigned int node, int depth, int alpha, int beta, bool isMax) {
+		FlatTreeAccess access(tree);
+		return hasLimits() ? run(access, node, depth, alpha, beta, isMax, EngineLimit(this)) : run(access, node, depth, alpha, beta, isMax, NoSearchLimit());
+	};
+	int staticEvaluator() override { return 0; };
+private:
+	GameStateAccess stateAccess;
+
+	// The engine's node and time budget and stop token, nodes counted across searches
+	class EngineLimit {
+	public:
+		explicit EngineLimit(TemplateAlphaBeta* e) : engine(e) {};
+		bool reached(long long nodes) { return engine->limitReached(engine->nodeCount + nodes); };
+		bool stopped() const { return engine->aborted.load(std::memory_order_relaxed); };
+	private:
+		TemplateAlphaBeta* engine;
+	};
+
+	template <class Tree, class Limit>
+	int run(Tree& access, typename Tree::Handle node, int depth, int alpha, int beta, bool isMax, Limit limit) {
+		SearchCore<Tree, Evaluator, Limit> core(access, Evaluator(), limit);
+		core.stats = &stats;
+		stats.setRoot(depth);
+		SearchResult result = core.searchRoot(node, depth, alpha, beta, isMax);
+		nodeCount += core.nodes;
+		rootChoice = result.bestIndex;
+		return result.value;
+	};
+};
+#pragma endregion
@@ -0,0 +1,144 @@
+/*************************************************************************************/
+// Search session class
+/*************************************************************************************/
+#include "SearchSession.h"
+
+#pragma region SearchSession
+SearchSession::SearchSession(AlphaBeta& e, unsigned int tableLog2) : engine(e), table(tableLog2) {
+	engine.setTranspositionTable(&table);
+	engine.setMoveOrderer(&orderer);
+}
+
+SearchSession::~SearchSession() {
+	if (reaper.valid())
+		reaper.wait();
+	engine.setTranspositionTable(nullptr);
+	engine.setMoveOrderer(nullptr);
+	delete root;
+}
+
+void SearchSession::setRoot(Node* node, bool max) {
+	delete root;
+	root = node;
+	state.reset();
+	isMax = max;
+}
+
+void SearchSession::setRoot(const GameState& s, bool max) {
+	delete root;
+	root = nullptr;
+	state = s.clone();
+	isMax = max;
+}
+
+// Root children are tried in hash move and history order. Each later child is
+// searched against the best value so far, so it only needs to prove it is not
+// better: its fail-hard bound never replaces the best and the root value stays exact.
+SearchResult SearchSession::search(int depth) {
+	SearchResult result;
+	std::vector<unsigned int> order;
+	unsigned long long key = root != nullptr ? TranspositionTable::Hash(root->name, isMax) : (state != nullptr ? state->key() : 0);
+	unsigned int count = childCount();
+	TableEntry entry;
+
+	engine.clearSearchCount();
+	if (searches++ > 0)
+		orderer.age();
+	if (depth <= 0 || count == 0) {
+		result.value = root != nullptr ? root->value : (state != nullptr ? state->evaluate() : 0);
+		result.nodes = 1;
+		return result;
+	}
+	for (unsigned int i = 0; i < count; i++)
+		order.push_back(i);
+	// The engine's plies start at the root children, the root itself has no killers
+	orderer.order(order, -1, table.Probe(key, entry) ? entry.move : 0, [this](unsigned int i) {
+		return root != nullptr ? TranspositionTable::Hash(root->children[i]->name, !isMax) : moveKey(moves[i]);
+	});
+
+	result.value = isMax ? engine.min : engine.max;
+	for (unsigned int i : order) {
+		int value = 0;
+		if (root != nullptr) {
+			value = isMax ?
+				engine.search(root->children[i], depth - 1, result.value, engine.max, false) :
+				engine.search(root->children[i], depth - 1, engine.min, result.value, true);
+		}
+		else {
+			state->apply(moves[i]);
+			value = isMax ?
+				engine.search(*state, depth - 1, result.value, engine.max, false) :
+				engine.search(*state, depth - 1, engine.min, result.value, true);
+			state->undo(moves[i]);
+		}
+		if (engine.searchAborted())
+			break;
+		if (result.bestIndex < 0 || (isMax ? value > result.value : value < result.value)) {
+			result.value = value;
+			result.bestIndex = (int)i;
+		}
+	}
+	// An aborted root is partial, only a finished one goes in the table
+	if (result.bestIndex >= 0 && !engine.searchAborted()) {
+		unsigned long long best = root != nullptr ? TranspositionTable::Hash(root->children[result.bestIndex]->name, !isMax) : moveKey(moves[result.bestIndex]);
+		table.Store(key, result.value, depth, Bound::Exact, best);
+	}
+	result.nodes = engine.searchCount() + 1;
+	return result;
+}
+
+// Keep child i as the new root, the old root and its other children go
+bool SearchSession::advance(unsigned int i) {
+	if (i >= childCount())
+		return false;
+	if (root != nullptr) {
+		Node* child = root->children[i];
+		std::vector<Node*> siblings;
+		siblings.swap(root->children);
+		siblings.erase(siblings.begin() + i);
+		delete root;
+		root = child;
+		discard(std::move(siblings));
+	}
+	else {
+		state->apply(moves[i]);
+	}
+	isMax = !isMax;
+	return true;
+}
+
+unsigned int SearchSession::childCount() {
+	if (root != nullptr)
+		return (unsigned int)root->children.size();
+	if (state == nullptr || state->isTerminal())
+		return 0;
+	state->generateMoves(moves);
+	return (unsigned int)moves.size();
+}
+
+std::string SearchSession::childName(unsigned int i) {
+	if (i >= childCount())
+		return "Not found";
+	if (root != nullptr)
+		return root->children[i]->name;
+	state->apply(moves[i]);
+	std::string name = state->name();
+	state->undo(moves[i]);
+	return name;
+}
+
+std::string SearchSession::rootName() const {
+	return root != nullptr ? root->name.str() : (state != nullptr ? state->name() : "");
+}
+
+// Subtrees can be large, free them off the searching thread. One batch is in
+// flight at a time.
+void SearchSession::discard(std::vector<Node*> nodes) {
+	if (reaper.valid())
+		reaper.wait();
+	reaper = std::async(std::launch::async, [](std::vector<Node*> garbage) {
+		for (Node* n : garbage)
+			delete n;
+	}, std::move(nodes));
+}
+#pragma endregion
@@ -0,0 +1,48 @@
+#pragma once
+/*************************************************************************************/
+// Search session class header
+// Keeps the state of a game between decisions: the current root, a transposition
+// table and move ordering history. After a search, advance() plays one root
+// child. Its subtree stays with the backed up values, the table entries and
+// history stay valid, so the next search starts warm. The discarded siblings
+// are freed on a background thread. The side to move flips with every advance.
+/*************************************************************************************/
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AlphaBeta.h"
+#include "GameState.h"
+#include "MoveOrdering.h"
+#include "SearchCore.h"
+#include "TranspositionTable.h"
+
+class SearchSession {
+public:
+	// The engine uses the session's table and orderer while the session lives
+	explicit SearchSession(AlphaBeta&, unsigned int tableLog2 = 16);
+	~SearchSession();
+	void setRoot(Node*, bool isMax = true);			// takes ownership
+	void setRoot(const GameState&, bool isMax = true);
+	SearchResult search(int);						// bestIndex is a root child / move index
+	bool advance(unsigned int);						// false if there is no such child
+	unsigned int childCount();
+	std::string childName(unsigned int);
+	std::string rootName() const;
+	bool rootIsMax() const { return isMax; };
+	const TranspositionTable& transpositionTable() const { return table; };
+private:
+	AlphaBeta& engine;
+	TranspositionTable table;
+	MoveOrderer orderer;
+	Node* root = nullptr;
+	std::unique_ptr<GameState> state;
+	std::vector<Move> moves;
+	bool isMax = true;
+	int searches = 0;
+	std::future<void> reaper;
+
+	void discard(std::vector<Node*>);
+	static unsigned long long moveKey(Move m) { return (unsigned long long)m + 1; };	// as the engines key moves
+};
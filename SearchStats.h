@@ -0,0 +1,85 @@
+#pragma once
+/*************************************************************************************/
+// Search statistics
+// Engines report the remaining depth they see, counters are kept by distance
+// from the root: setRoot gives the depth a search starts from, so searches of
+// different depths, deepening iterations or helper threads, add up ply by ply.
+// Each thread keeps its own SearchStats and they are merged after the search,
+// nothing here is shared or atomic.
+/*************************************************************************************/
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct PlyStats {
+	long long nodes = 0;
+	long long leaves = 0;					// evaluated, at depth 0 or terminal
+	long long betaCutoffs = 0;				// max node reached beta
+	long long alphaCutoffs = 0;				// min node fell to alpha
+	long long firstChildCutoffs = 0;		// either cutoff on the first child searched
+};
+
+class SearchStats {
+public:
+	void node(int depth) { at(depth).nodes++; };
+	void leaf(int depth) { at(depth).leaves++; };
+	void cutoff(int depth, bool isMax, bool first) {
+		PlyStats& p = at(depth);
+		if (isMax)
+			p.betaCutoffs++;
+		else
+			p.alphaCutoffs++;
+		if (first)
+			p.firstChildCutoffs++;
+	};
+	void setRoot(int depth) { rootDepth = depth; };	// before each search
+	void clear() { plies.clear(); };
+
+	void merge(const SearchStats& other) {
+		if (plies.size() < other.plies.size())
+			plies.resize(other.plies.size());
+		for (size_t p = 0; p < other.plies.size(); p++) {
+			plies[p].nodes += other.plies[p].nodes;
+			plies[p].leaves += other.plies[p].leaves;
+			plies[p].betaCutoffs += other.plies[p].betaCutoffs;
+			plies[p].alphaCutoffs += other.plies[p].alphaCutoffs;
+			plies[p].firstChildCutoffs += other.plies[p].firstChildCutoffs;
+		}
+	};
+
+	int plyCount() const { return (int)plies.size(); };		// down to the deepest ply reached
+	const PlyStats& ply(int p) const { return plies[p]; };
+
+	long long totalNodes() const {
+		long long n = 0;
+		for (const PlyStats& p : plies)
+			n += p.nodes;
+		return n;
+	};
+
+	// Nodes at the next ply per interior node at this one
+	double branchingFactor(int p) const {
+		long long interior = ply(p).nodes - ply(p).leaves;
+		return p + 1 < plyCount() && interior > 0 ? (double)ply(p + 1).nodes / interior : 0.0;
+	};
+
+	// One JSON object per line, label names the search
+	void writeJson(std::ostream& out, const std::string& label) const {
+		for (int p = 0; p < plyCount(); p++) {
+			const PlyStats& s = ply(p);
+			out << "{\"search\":\"" << label << "\",\"ply\":" << p << ",\"nodes\":" << s.nodes << ",\"leaves\":" << s.leaves
+				<< ",\"beta_cutoffs\":" << s.betaCutoffs << ",\"alpha_cutoffs\":" << s.alphaCutoffs
+				<< ",\"first_child_cutoffs\":" << s.firstChildCutoffs << ",\"ebf\":" << branchingFactor(p) << "}" << std::endl;
+		}
+	};
+private:
+	std::vector<PlyStats> plies;			// indexed by distance from the root
+	int rootDepth = 0;
+
+	PlyStats& at(int depth) {
+		size_t p = depth < rootDepth ? (size_t)(rootDepth - depth) : 0;
+		if (p >= plies.size())
+			plies.resize(p + 1);
+		return plies[p];
+	};
+};
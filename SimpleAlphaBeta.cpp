@@ -1,44 +1,106 @@
+#include <cstdint>
+
 #include "AlphaBeta.h"
 #include "SimpleAlphaBeta.h"
 
 #pragma region SimpleAlphaBeta
-	// AlphaBeta Pruning function
+// Entry points, statistics count plies from here
 int SimpleAlphaBeta::search(Node* node, int depth, int alpha, int beta, bool isMax) {
+	stats.setRoot(depth);
+	startDepth = depth;
+	return searchNode(node, depth, alpha, beta, isMax);
+}
+
+int SimpleAlphaBeta::search(FlatTree& tree, unsigned int node, int depth, int alpha, int beta, bool isMax) {
+	stats.setRoot(depth);
+	startDepth = depth;
+	return searchFlat(tree, node, depth, alpha, beta, isMax);
+}
+
+int SimpleAlphaBeta::search(GameState& state, int depth, int alpha, int beta, bool isMax) {
+	stats.setRoot(depth);
+	startDepth = depth;
+	return searchState(state, depth, alpha, beta, isMax);
+}
+
+	// AlphaBeta Pruning function
+int SimpleAlphaBeta::searchNode(Node* node, int depth, int alpha, int beta, bool isMax) {
 	int bestValue = 0;
 	int childValue = 0;
 	int bestChildValue = isMax ? min : max;
-	std::vector<Node*> temp;
+	unsigned long long key = 0;
+	unsigned long long hashMove = 0;
+	Node* bestMove = nullptr;
+
+	nodePV.clear(depth);
+	if (limitReached(nodeCount))
+		return isMax ? alpha : beta;
+
+	// Positions already searched deep enough come straight from the table
+	if (table != nullptr && depth > 0 && node->children.size() > 0) {
+		key = TranspositionTable::Hash(node->name, isMax);
+		if (probeTable(key, depth, alpha, beta, bestValue, hashMove)) {
+			node->value = bestValue;
+			nodeCount++;
+			stats.node(depth);
+			return bestValue;
+		}
+	}
 
-	if ((depth == 0) || (node->children.size() == 0)) {
+	if ((depth <= 0) || (node->children.size() == 0)) {
 		bestValue = node->value;
+		stats.leaf(depth);
 	}
 	else if (isMax) {
 		bestValue = alpha;
+		const std::vector<Node*>& children = orderChildren(node, depth, isMax, hashMove);
 
 		// Recurse for all children of node.
-		for (Node* n : node->children) {
-			childValue = search(n, depth - 1, bestValue, beta, false);
-			bestValue = childValue > bestValue ? childValue : bestValue;
+		for (Node* n : children) {
+			childValue = searchNode(n, depth - 1, bestValue, beta, false);
+			if (aborted)
+				return bestValue;		// partial, nothing is stored or written back
+			if (childValue > bestValue) {
+				bestValue = childValue;
+				bestMove = n;
+				nodePV.update(depth, n);
+			}
 			if (beta <= bestValue) {
-				std::cout << "\tcutoff: " << n->name << std::endl;
+				trace.cutoff((unsigned long long)(uintptr_t)n, n->name.c_str(), depth, alpha, beta);
+				stats.cutoff(depth, isMax, n == children[0]);
+				if (orderer != nullptr)
+					orderer->cutoff(TranspositionTable::Hash(n->name, !isMax), startDepth - depth, depth, n == children[0]);
 				break;
 			}
 		}
 	}
 	else {
 		bestValue = beta;
+		const std::vector<Node*>& children = orderChildren(node, depth, isMax, hashMove);
 
 		// Recurse for all children of node.
-		for (Node* n : node->children) {
-			childValue = search(n, depth - 1, alpha, bestValue, true);
-			bestValue = childValue < bestValue ? childValue : bestValue;
+		for (Node* n : children) {
+			childValue = searchNode(n, depth - 1, alpha, bestValue, true);
+			if (aborted)
+				return bestValue;
+			if (childValue < bestValue) {
+				bestValue = childValue;
+				bestMove = n;
+				nodePV.update(depth, n);
+			}
 			if (bestValue <= alpha) {
-				std::cout << "\tcutoff: " << n->name << std::endl;
+				trace.cutoff((unsigned long long)(uintptr_t)n, n->name.c_str(), depth, alpha, beta);
+				stats.cutoff(depth, isMax, n == children[0]);
+				if (orderer != nullptr)
+					orderer->cutoff(TranspositionTable::Hash(n->name, !isMax), startDepth - depth, depth, n == children[0]);
 				break;
 			}
 		}
 	}
 
+	if (table != nullptr && depth > 0 && node->children.size() > 0)
+		storeTable(key, depth, alpha, beta, bestValue, bestMove == nullptr ? 0 : TranspositionTable::Hash(bestMove->name, !isMax));
+
 	// Save the best child value found
 	if (node->children.size() > 0)
 	{
@@ -62,9 +124,275 @@ int SimpleAlphaBeta::search(Node* node, int depth, int alpha, int beta, bool isM
 		node->value = bestChildValue;
 	}
 	nodeCount++;
+	stats.node(depth);
+	return bestValue;
+}
+
+// AlphaBeta Pruning over a flat tree, node is an index into tree
+int SimpleAlphaBeta::searchFlat(FlatTree& tree, unsigned int node, int depth, int alpha, int beta, bool isMax) {
+	int bestValue = 0;
+	int childValue = 0;
+	unsigned int first = tree.firstChild[node];
+	unsigned int last = first + tree.childCount[node];
+	unsigned long long key = 0;
+	unsigned long long hashMove = 0;
+	unsigned int bestMove = 0;
+
+	indexPV.clear(depth);
+	if (limitReached(nodeCount))
+		return isMax ? alpha : beta;
+
+	// Positions already searched deep enough come straight from the table
+	if (table != nullptr && depth > 0 && first != last) {
+		key = TranspositionTable::Hash(tree.NameData(node), isMax);
+		if (probeTable(key, depth, alpha, beta, bestValue, hashMove)) {
+			if (!readOnly)
+				tree.values[node] = bestValue;
+			nodeCount++;
+			stats.node(depth);
+			return bestValue;
+		}
+	}
+
+	if ((depth <= 0) || (first == last)) {
+		bestValue = tree.values[node];
+		stats.leaf(depth);
+	}
+	else if (isMax) {
+		bestValue = alpha;
+		const std::vector<unsigned int>* order = orderChildren(tree, node, depth, isMax, hashMove);
+
+		// Recurse for all children of node.
+		for (unsigned int k = 0; k < last - first; k++) {
+			unsigned int c = order != nullptr ? (*order)[k] : first + k;
+			childValue = searchFlat(tree, c, depth - 1, bestValue, beta, false);
+			if (aborted)
+				return bestValue;		// partial, nothing is stored or written back
+			if (childValue > bestValue) {
+				bestValue = childValue;
+				bestMove = c;
+				indexPV.update(depth, c);
+			}
+			if (beta <= bestValue) {
+				trace.cutoff(c, tree.NameData(c), depth, alpha, beta);
+				stats.cutoff(depth, isMax, k == 0);
+				if (orderer != nullptr)
+					orderer->cutoff(TranspositionTable::Hash(tree.NameData(c), !isMax), startDepth - depth, depth, k == 0);
+				break;
+			}
+		}
+	}
+	else {
+		bestValue = beta;
+		const std::vector<unsigned int>* order = orderChildren(tree, node, depth, isMax, hashMove);
+
+		// Recurse for all children of node.
+		for (unsigned int k = 0; k < last - first; k++) {
+			unsigned int c = order != nullptr ? (*order)[k] : first + k;
+			childValue = searchFlat(tree, c, depth - 1, alpha, bestValue, true);
+			if (aborted)
+				return bestValue;
+			if (childValue < bestValue) {
+				bestValue = childValue;
+				bestMove = c;
+				indexPV.update(depth, c);
+			}
+			if (bestValue <= alpha) {
+				trace.cutoff(c, tree.NameData(c), depth, alpha, beta);
+				stats.cutoff(depth, isMax, k == 0);
+				if (orderer != nullptr)
+					orderer->cutoff(TranspositionTable::Hash(tree.NameData(c), !isMax), startDepth - depth, depth, k == 0);
+				break;
+			}
+		}
+	}
+
+	if (table != nullptr && depth > 0 && first != last)
+		storeTable(key, depth, alpha, beta, bestValue, bestMove == 0 ? 0 : TranspositionTable::Hash(tree.NameData(bestMove), !isMax));
+
+	// Save the best child value found
+	if (first != last && !readOnly) {
+		int bestChildValue = tree.values[first];
+		for (unsigned int c = first; c < last; c++) {
+			if (isMax)
+				bestChildValue = tree.values[c] > bestChildValue ? tree.values[c] : bestChildValue;
+			else
+				bestChildValue = tree.values[c] < bestChildValue ? tree.values[c] : bestChildValue;
+		}
+		tree.values[node] = bestChildValue;
+	}
+	nodeCount++;
+	stats.node(depth);
+	return bestValue;
+}
+
+// AlphaBeta Pruning over a game state, children are generated as they are visited
+int SimpleAlphaBeta::searchState(GameState& state, int depth, int alpha, int beta, bool isMax) {
+	int bestValue = 0;
+	int childValue = 0;
+	unsigned long long key = 0;
+	unsigned long long hashMove = 0;
+	unsigned long long bestMove = 0;
+
+	movePV.clear(depth);
+	if (limitReached(nodeCount))
+		return isMax ? alpha : beta;
+
+	// Endgame table positions are exact at any depth
+	if (state.probe(bestValue)) {
+		nodeCount++;
+		stats.node(depth);
+		stats.leaf(depth);
+		return bestValue;
+	}
+	if ((depth <= 0) || state.isTerminal()) {
+		nodeCount++;
+		stats.node(depth);
+		stats.leaf(depth);
+		return state.evaluate();
+	}
+
+	// Positions already searched deep enough come straight from the table
+	if (table != nullptr) {
+		key = state.key();
+		if (probeTable(key, depth, alpha, beta, bestValue, hashMove)) {
+			nodeCount++;
+			stats.node(depth);
+			return bestValue;
+		}
+	}
+
+	if (moveStack.size() <= (size_t)depth)
+		moveStack.resize(depth + 1);
+	std::vector<Move>& moves = moveStack[depth];
+	state.generateMoves(moves);
+	if (orderer != nullptr)
+		orderer->order(moves, startDepth - depth, hashMove, moveKey);
+	perturb(moves, depth);
+
+	if (isMax) {
+		bestValue = alpha;
+
+		// Recurse for all moves from this state.
+		for (Move m : moves) {
+			state.apply(m);
+			childValue = searchState(state, depth - 1, bestValue, beta, false);
+			state.undo(m);
+			if (aborted)
+				return bestValue;		// partial, nothing is stored
+			if (childValue > bestValue) {
+				bestValue = childValue;
+				bestMove = moveKey(m);
+				movePV.update(depth, m);
+			}
+			if (beta <= bestValue) {
+				trace.cutoff(SearchTrace::enabled ? state.key() : 0, nullptr, depth, alpha, beta);
+				stats.cutoff(depth, isMax, m == moves[0]);
+				if (orderer != nullptr)
+					orderer->cutoff(moveKey(m), startDepth - depth, depth, m == moves[0]);
+				break;
+			}
+		}
+	}
+	else {
+		bestValue = beta;
+
+		// Recurse for all moves from this state.
+		for (Move m : moves) {
+			state.apply(m);
+			childValue = searchState(state, depth - 1, alpha, bestValue, true);
+			state.undo(m);
+			if (aborted)
+				return bestValue;
+			if (childValue < bestValue) {
+				bestValue = childValue;
+				bestMove = moveKey(m);
+				movePV.update(depth, m);
+			}
+			if (bestValue <= alpha) {
+				trace.cutoff(SearchTrace::enabled ? state.key() : 0, nullptr, depth, alpha, beta);
+				stats.cutoff(depth, isMax, m == moves[0]);
+				if (orderer != nullptr)
+					orderer->cutoff(moveKey(m), startDepth - depth, depth, m == moves[0]);
+				break;
+			}
+		}
+	}
+
+	if (table != nullptr)
+		storeTable(key, depth, alpha, beta, bestValue, bestMove);
+	nodeCount++;
+	stats.node(depth);
 	return bestValue;
 }
 
+// Fail-hard table probe, true if the stored entry decides this window
+bool SimpleAlphaBeta::probeTable(unsigned long long key, int depth, int alpha, int beta, int& value, unsigned long long& hashMove) {
+	TableEntry entry;
+	bool found = table->Probe(key, entry);
+
+	hashMove = found ? entry.move : 0;
+	if (found && entry.depth >= depth && depth != rootDepth) {
+		if (entry.bound == Bound::Exact) {
+			value = entry.value < alpha ? alpha : (entry.value > beta ? beta : entry.value);
+			tableHits++;
+			return true;
+		}
+		if (entry.bound == Bound::Lower && entry.value >= beta) {
+			value = beta;
+			tableHits++;
+			return true;
+		}
+		if (entry.bound == Bound::Upper && entry.value <= alpha) {
+			value = alpha;
+			tableHits++;
+			return true;
+		}
+	}
+	tableMisses++;
+	return false;
+}
+
+void SimpleAlphaBeta::storeTable(unsigned long long key, int depth, int alpha, int beta, int value, unsigned long long move) {
+	Bound bound = Bound::Exact;
+
+	if (value <= alpha)
+		bound = Bound::Upper;
+	else if (value >= beta)
+		bound = Bound::Lower;
+	table->Store(key, value, depth, bound, bound == Bound::Upper ? 0 : move);
+}
+
+// Children in search order, the tree order unless a move orderer is attached
+const std::vector<Node*>& SimpleAlphaBeta::orderChildren(Node* node, int depth, bool isMax, unsigned long long hashMove) {
+	if (orderer == nullptr && siblingOffset == 0)
+		return node->children;
+	if (nodeOrder.size() <= (size_t)depth)
+		nodeOrder.resize(depth + 1);
+	std::vector<Node*>& children = nodeOrder[depth];
+	children = node->children;
+	if (orderer != nullptr)
+		orderer->order(children, startDepth - depth, hashMove, [isMax](Node* n) { return TranspositionTable::Hash(n->name, !isMax); });
+	perturb(children, depth);
+	return children;
+}
+
+// Children in tree order are the contiguous range from firstChild, nullptr then
+const std::vector<unsigned int>* SimpleAlphaBeta::orderChildren(FlatTree& tree, unsigned int node, int depth, bool isMax, unsigned long long hashMove) {
+	if (orderer == nullptr && siblingOffset == 0)
+		return nullptr;
+	if (indexOrder.size() <= (size_t)depth)
+		indexOrder.resize(depth + 1);
+	std::vector<unsigned int>& children = indexOrder[depth];
+	children.clear();
+	for (unsigned int c = tree.firstChild[node]; c < tree.firstChild[node] + tree.childCount[node]; c++)
+		children.push_back(c);
+	if (orderer != nullptr)
+		orderer->order(children, startDepth - depth, hashMove, [&tree, isMax](unsigned int c) { return TranspositionTable::Hash(tree.NameData(c), !isMax); });
+	perturb(children, depth);
+	return &children;
+}
+
 int SimpleAlphaBeta::staticEvaluator() {
 	return 0;
 }
@@ -72,21 +400,20 @@ int SimpleAlphaBeta::staticEvaluator() {
 
 #pragma region Node
 // ctor
-Node::Node(std::string n, int v, bool dbg) : name(n), value(v), debug(dbg) {
-	if (debug)
+Node::Node(const std::string& n, int v, bool dbg) : name(n), value(v), debug(dbg) {
+	if (SearchTrace::enabled && debug)
 		std::cout << " - Creatinging node: " << name;
 }
 //dtor
 Node::~Node() {
-	if (debug)
+	if (SearchTrace::enabled && debug)
 		std::cout << "\tDestroying node: " << name << std::endl;
 	for (Node* c : children) {
 		delete c;
 	}
 }
-Node& Node::AddChild(std::string n, int v) {
-	child = new Node(n, v);
-	children.push_back(child);
+Node& Node::AddChild(const std::string& n, int v) {
+	children.push_back(new Node(n, v));
 	return *this;
 }
 #pragma endregion
@@ -1,8 +1,50 @@
 #pragma once
+#include <algorithm>
+
 #include "AlphaBeta.h"
+#include "FlatTree.h"
+#include "PrincipalVariation.h"
 
 class SimpleAlphaBeta : public AlphaBeta {
 public:
 	int search(Node*, int, int, int, bool) override;
+	int search(FlatTree&, unsigned int, int, int, int, bool);
+	int search(GameState&, int, int, int, bool) override;
 	int staticEvaluator() override;
+	// Best line of the last search called with depth, it starts with the chosen
+	// child. Cut short where a table hit or a fail ended it.
+	const std::vector<Node*>& nodeVariation(int depth) const { return nodePV.line(depth); };
+	const std::vector<unsigned int>& flatVariation(int depth) const { return indexPV.line(depth); };
+	const std::vector<Move>& moveVariation(int depth) const { return movePV.line(depth); };
+	// Rotates all but the first child by offset + depth, so helper threads
+	// sharing a table walk the siblings in different orders. 0 is tree order.
+	void setSiblingOffset(unsigned int o) { siblingOffset = o; };
+	// Table hits at this depth only supply the hash move, so a search started
+	// there always walks its root and reports a variation. -1 for none.
+	void setRootDepth(int d) { rootDepth = d; };
+	// Flat searches store no backed up values, so threads may share the tree
+	void setReadOnly(bool r) { readOnly = r; };
+private:
+	unsigned int siblingOffset = 0;
+	bool readOnly = false;
+	int rootDepth = -1;
+	int startDepth = 0;								// of the current search call, plies count from it
+	int searchNode(Node*, int, int, int, bool);
+	int searchFlat(FlatTree&, unsigned int, int, int, int, bool);
+	int searchState(GameState&, int, int, int, bool);
+	bool probeTable(unsigned long long, int, int, int, int&, unsigned long long&);
+	void storeTable(unsigned long long, int, int, int, int, unsigned long long);
+	const std::vector<Node*>& orderChildren(Node*, int, bool, unsigned long long);
+	const std::vector<unsigned int>* orderChildren(FlatTree&, unsigned int, int, bool, unsigned long long);
+	static unsigned long long moveKey(Move m) { return (unsigned long long)m + 1; };	// 0 is no move
+	template <class T> void perturb(std::vector<T>& children, int depth) {
+		if (siblingOffset != 0 && children.size() > 2)
+			std::rotate(children.begin() + 1, children.begin() + 1 + (siblingOffset + depth) % (children.size() - 1), children.end());
+	};
+	std::vector<std::vector<Move>> moveStack;		// generated moves, indexed by depth
+	std::vector<std::vector<Node*>> nodeOrder;		// ordered children, indexed by depth
+	std::vector<std::vector<unsigned int>> indexOrder;
+	PVTable<Node*> nodePV;
+	PVTable<unsigned int> indexPV;
+	PVTable<Move> movePV;
 };
@@ -0,0 +1,53 @@
+/**************************************************************/
+// Nim tablebase generator
+// Solves every position up to the given size offline and writes
+// the packed table for SimpleABP -tablebase:
+//   TablebaseGen -heaps <n> -max <stones> [-misere] -out <file>
+/**************************************************************/
+#include <iostream>
+#include <string>
+
+// Local includes
+#include "NimTablebase.h"
+#include "elapseTimer.h"
+
+int main(int argc, char* argv[]) {
+	unsigned int heaps = 3;
+	unsigned int maxHeap = 8;
+	bool misere = false;
+	std::string out;
+	ElapsedTimer timer;
+
+	for (int i = 1; i < argc; i++) {
+		std::string option = argv[i];
+		if (option == "-heaps" && i + 1 < argc)
+			heaps = (unsigned int)std::stoi(argv[++i]);
+		else if (option == "-max" && i + 1 < argc)
+			maxHeap = (unsigned int)std::stoi(argv[++i]);
+		else if (option == "-misere")
+			misere = true;
+		else if (option == "-out" && i + 1 < argc)
+			out = argv[++i];
+	}
+	if (out.empty()) {
+		std::cerr << "Usage: TablebaseGen -heaps <n> -max <stones> [-misere] -out <file>" << std::endl;
+		return 1;
+	}
+
+	try {
+		NimTablebase table(heaps, maxHeap, misere);
+		timer.Start();
+		table.generate();
+		timer.Stop();
+		table.save(out);
+		std::cout << (misere ? "Misere" : "Normal") << " tablebase, " << heaps << " heaps of up to " << maxHeap << " stones: "
+			<< table.size() << " positions in " << table.memoryBytes() << " bytes, "
+			<< timer.DurationMillis() << "ms" << std::endl;
+		std::cout << "Written to " << out << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
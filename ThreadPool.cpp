@@ -0,0 +1,105 @@
+/*************************************************************************************/
+// Work stealing thread pool class
+/*************************************************************************************/
+#include <chrono>
+
+#include "ThreadPool.h"
+
+namespace {
+	// Pools nest, a worker of one may search with an engine owning another, so
+	// the index is only meaningful together with its pool
+	thread_local const ThreadPool* currentPool = nullptr;
+	thread_local int currentWorker = -1;
+}
+
+#pragma region ThreadPool
+ThreadPool::ThreadPool(unsigned int threads) {
+	if (threads == 0)
+		threads = 1;
+	for (unsigned int i = 0; i < threads; i++)
+		queues.emplace_back(new Queue());
+	for (unsigned int i = 0; i < threads; i++)
+		workers.emplace_back(&ThreadPool::workerLoop, this, (int)i);
+}
+
+ThreadPool::~ThreadPool() {
+	stopping = true;
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		wake.notify_all();
+	}
+	for (std::thread& t : workers)
+		t.join();
+}
+
+int ThreadPool::workerIndex() const {
+	return currentPool == this ? currentWorker : -1;
+}
+
+// Tasks from a worker go on its own deque, others are spread round robin
+void ThreadPool::run(TaskGroup& group, std::function<void()> task) {
+	int self = workerIndex();
+	unsigned int target = self >= 0 ? (unsigned int)self : next++ % size();
+
+	group.pending++;
+	{
+		std::lock_guard<std::mutex> guard(queues[target]->lock);
+		queues[target]->tasks.emplace_back([&group, task]() {
+			task();
+			group.pending--;
+		});
+	}
+	queued++;
+	std::lock_guard<std::mutex> guard(sleepLock);
+	wake.notify_one();
+}
+
+// Help with queued work until every task of the group has finished
+void ThreadPool::wait(TaskGroup& group) {
+	while (group.pending.load() > 0) {
+		if (!runOne(workerIndex()))
+			std::this_thread::yield();
+	}
+}
+
+bool ThreadPool::runOne(int self) {
+	std::function<void()> task;
+	unsigned int n = (unsigned int)queues.size();		// workers may still be starting
+
+	if (queued.load() == 0)
+		return false;
+	// Own deque first, newest task
+	if (self >= 0) {
+		std::lock_guard<std::mutex> guard(queues[self]->lock);
+		if (!queues[self]->tasks.empty()) {
+			task = std::move(queues[self]->tasks.back());
+			queues[self]->tasks.pop_back();
+		}
+	}
+	// Then steal the oldest task of another worker
+	for (unsigned int i = 1; !task && i <= n; i++) {
+		unsigned int victim = ((self >= 0 ? self : 0) + i) % n;
+		std::lock_guard<std::mutex> guard(queues[victim]->lock);
+		if (!queues[victim]->tasks.empty()) {
+			task = std::move(queues[victim]->tasks.front());
+			queues[victim]->tasks.pop_front();
+		}
+	}
+	if (!task)
+		return false;
+	queued--;
+	task();
+	return true;
+}
+
+void ThreadPool::workerLoop(int index) {
+	currentPool = this;
+	currentWorker = index;
+	while (!stopping) {
+		if (!runOne(index)) {
+			std::unique_lock<std::mutex> guard(sleepLock);
+			wake.wait_for(guard, std::chrono::milliseconds(1), [this]() { return stopping || queued.load() > 0; });
+		}
+	}
+}
+#pragma endregion
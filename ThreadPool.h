@@ -0,0 +1,45 @@
+#pragma once
+/*************************************************************************************/
+// Work stealing thread pool class header
+// Every worker owns a task deque: it pops its own tasks newest first and steals
+// the oldest tasks of other workers when idle. Waiting on a task group helps
+// run queued tasks, so tasks may spawn and wait on nested groups.
+/*************************************************************************************/
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskGroup {
+public:
+	std::atomic<int> pending{ 0 };
+};
+
+class ThreadPool {
+public:
+	explicit ThreadPool(unsigned int threads = std::thread::hardware_concurrency());
+	~ThreadPool();
+	void run(TaskGroup&, std::function<void()>);
+	void wait(TaskGroup&);
+	unsigned int size() const { return (unsigned int)workers.size(); };
+	int workerIndex() const;					// of the calling thread, -1 outside this pool
+private:
+	struct Queue {
+		std::mutex lock;
+		std::deque<std::function<void()>> tasks;
+	};
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+	std::atomic<bool> stopping{ false };
+	std::atomic<unsigned int> next{ 0 };
+	std::atomic<int> queued{ 0 };
+	std::mutex sleepLock;
+	std::condition_variable wake;
+
+	bool runOne(int);
+	void workerLoop(int);
+};
@@ -0,0 +1,81 @@
+#pragma once
+/*************************************************************************************/
+// Search trace policies
+// NoTrace compiles every call away. RingTrace records cutoff events into a fixed
+// lock-free ring buffer that threads write concurrently and that is dumped after
+// the search. Define ABP_TRACE at compile time to select RingTrace.
+/*************************************************************************************/
+#include <atomic>
+#include <ostream>
+#include <vector>
+
+struct CutoffEvent {
+	unsigned long long node = 0;			// node id: tree index, position key or address
+	const char* label = nullptr;			// optional name, must outlive the dump
+	int depth = 0;
+	int alpha = 0;
+	int beta = 0;
+	std::atomic<unsigned long long> sequence{ 0 };
+};
+
+class NoTrace {
+public:
+	static const bool enabled = false;
+	void cutoff(unsigned long long, const char*, int, int, int) {};
+	void dump(std::ostream&) {};
+	void clear() {};
+};
+
+template <unsigned int SizeLog2>
+class RingTrace {
+public:
+	static const bool enabled = true;
+
+	RingTrace() : events(1ULL << SizeLog2) {};
+
+	// Claim a slot, fill it, then publish it with its sequence number
+	void cutoff(unsigned long long node, const char* label, int depth, int alpha, int beta) {
+		unsigned long long index = head.fetch_add(1, std::memory_order_relaxed);
+		CutoffEvent& e = events[index & mask];
+		e.node = node;
+		e.label = label;
+		e.depth = depth;
+		e.alpha = alpha;
+		e.beta = beta;
+		e.sequence.store(index + 1, std::memory_order_release);
+	};
+
+	// Oldest event still in the ring first, slots being rewritten are skipped
+	void dump(std::ostream& out) {
+		unsigned long long end = head.load(std::memory_order_acquire);
+		unsigned long long start = end > events.size() ? end - events.size() : 0;
+
+		if (start > 0)
+			out << "\t(" << start << " older cutoffs dropped)" << std::endl;
+		for (unsigned long long i = start; i < end; i++) {
+			CutoffEvent& e = events[i & mask];
+			if (e.sequence.load(std::memory_order_acquire) != i + 1)
+				continue;
+			out << "\tcutoff: ";
+			if (e.label != nullptr)
+				out << e.label << " ";
+			out << "#" << e.node << " depth " << e.depth << " alpha " << e.alpha << " beta " << e.beta << std::endl;
+		}
+	};
+
+	void clear() {
+		head = 0;
+		for (CutoffEvent& e : events)
+			e.sequence = 0;
+	};
+private:
+	static const unsigned long long mask = (1ULL << SizeLog2) - 1;
+	std::vector<CutoffEvent> events;
+	std::atomic<unsigned long long> head{ 0 };
+};
+
+#ifdef ABP_TRACE
+typedef RingTrace<16> SearchTrace;
+#else
+typedef NoTrace SearchTrace;
+#endif
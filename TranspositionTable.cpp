@@ -0,0 +1,78 @@
+/*************************************************************************************/
+// Transposition table class
+/*************************************************************************************/
+#include "TranspositionTable.h"
+
+#pragma region TranspositionTable
+// Value initialised, every slot starts empty
+TranspositionTable::TranspositionTable(unsigned int sizeLog2) :
+	entries(new Slot[2ULL << sizeLog2]()), mask((1ULL << sizeLog2) - 1) {}
+
+bool TranspositionTable::Probe(unsigned long long key, TableEntry& entry) const {
+	const Slot* bucket = &entries[(key & mask) * 2];
+
+	for (int i = 0; i < 2; i++) {
+		if (read(bucket[i], entry) && entry.key == key)
+			return true;
+	}
+	return false;
+}
+
+// Replacement: the first slot keeps the deepest search of a bucket, anything
+// shallower goes to the second slot, which is always overwritten. Racing stores
+// may lose an entry, never corrupt one.
+void TranspositionTable::Store(unsigned long long key, int value, int depth, Bound bound, unsigned long long move) {
+	Slot* bucket = &entries[(key & mask) * 2];
+	Slot* slot = &bucket[1];
+	TableEntry deep;
+	TableEntry old;
+	bool deepValid = read(bucket[0], deep);
+
+	if (!deepValid || deep.key == key || depth >= deep.depth) {
+		// Demote the old deep entry rather than lose it, from the words that were
+		// checked: the slot may have been overwritten since
+		if (deepValid && deep.key != key)
+			write(bucket[1], deep.key, pack(deep.value, deep.depth, deep.bound), deep.move);
+		slot = &bucket[0];
+	}
+	// A fail low has no best move, keep the one found earlier
+	if (move == 0 && read(*slot, old) && old.key == key)
+		move = old.move;
+	write(*slot, key, pack(value, depth, bound), move);
+}
+
+void TranspositionTable::clear() {
+	for (unsigned long long i = 0; i < size(); i++)
+		write(entries[i], 0, 0, 0);
+}
+
+uint64_t TranspositionTable::pack(int value, int depth, Bound bound) {
+	return (uint64_t)(uint32_t)value | (uint64_t)(uint16_t)depth << 32 | (uint64_t)bound << 48;
+}
+
+bool TranspositionTable::read(const Slot& slot, TableEntry& entry) {
+	uint64_t check = slot.check.load(std::memory_order_relaxed);
+	uint64_t data = slot.data.load(std::memory_order_relaxed);
+	uint64_t move = slot.move.load(std::memory_order_relaxed);
+
+	entry.bound = (Bound)(data >> 48);
+	if (entry.bound == Bound::None)
+		return false;
+	entry.key = check ^ data ^ move;
+	entry.value = (int)(uint32_t)data;
+	entry.depth = (int)(uint16_t)(data >> 32);
+	entry.move = move;
+	return true;
+}
+
+void TranspositionTable::write(Slot& slot, uint64_t key, uint64_t data, uint64_t move) {
+	slot.data.store(data, std::memory_order_relaxed);
+	slot.move.store(move, std::memory_order_relaxed);
+	slot.check.store(key ^ data ^ move, std::memory_order_relaxed);
+}
+
+// FNV-1a over the position name, salted with the side to move
+unsigned long long TranspositionTable::Hash(const char* name, bool isMax) {
+	return NamePool::Hash(name) ^ (isMax ? sideSalt : 0);
+}
+#pragma endregion
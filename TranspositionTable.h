@@ -0,0 +1,50 @@
+#pragma once
+/*************************************************************************************/
+// Transposition table class header
+// Fixed size table of searched positions keyed by a 64 bit position hash. Each
+// bucket holds a depth-preferred slot and an always-replace slot.
+// The table is lock-free and may be shared by any number of searching threads.
+// A slot is three atomic words: value, depth and bound packed into one, the best
+// move, and the key XORed with both. A read torn by a concurrent write fails the
+// XOR check and is simply a miss.
+/*************************************************************************************/
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "NamePool.h"
+
+enum class Bound : unsigned char { None, Exact, Lower, Upper };
+
+struct TableEntry {
+	unsigned long long key = 0;
+	int value = 0;
+	int depth = -1;
+	Bound bound = Bound::None;
+	unsigned long long move = 0;			// best move key, 0 if none
+};
+
+class TranspositionTable {
+public:
+	explicit TranspositionTable(unsigned int sizeLog2 = 16);	// 2^sizeLog2 buckets
+	bool Probe(unsigned long long, TableEntry&) const;
+	void Store(unsigned long long, int, int, Bound, unsigned long long move = 0);
+	void clear();
+	unsigned int size() const { return (unsigned int)(2 * (mask + 1)); };
+	static unsigned long long Hash(const char*, bool);			// position name and side to move
+	static unsigned long long Hash(const InternedName& name, bool isMax) { return name.hash() ^ (isMax ? sideSalt : 0); };
+private:
+	struct Slot {
+		std::atomic<uint64_t> check;		// key ^ data ^ move
+		std::atomic<uint64_t> data;			// value, depth << 32, bound << 48
+		std::atomic<uint64_t> move;
+	};
+
+	static const unsigned long long sideSalt = 0x9E3779B97F4A7C15ULL;
+	std::unique_ptr<Slot[]> entries;
+	unsigned long long mask;
+
+	static uint64_t pack(int value, int depth, Bound bound);
+	static bool read(const Slot&, TableEntry&);
+	static void write(Slot&, uint64_t key, uint64_t data, uint64_t move);
+};
@@ -0,0 +1,186 @@
+/*************************************************************************************/
+// Binary tree file writer and memory mapped loader
+/*************************************************************************************/
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "TreeFile.h"
+
+namespace {
+	uint64_t align8(uint64_t offset) {
+		return (offset + 7) & ~7ULL;
+	}
+
+	// An array of size bytes at offset lies inside a file of length bytes, without overflowing
+	bool inside(uint64_t offset, uint64_t size, uint64_t length) {
+		return offset <= length && size <= length - offset;
+	}
+
+	void writeAt(std::ofstream& out, uint64_t offset, const void* data, size_t size) {
+		out.seekp((std::streamoff)offset);
+		out.write((const char*)data, (std::streamsize)size);
+	}
+}
+
+#pragma region TreeFileWriter
+void WriteTreeFile(const std::string& path, const FlatTree& tree, bool names) {
+	TreeFileHeader header;
+	uint64_t n = tree.size();
+	std::vector<uint32_t> offsets;
+
+	names = names && !tree.NameTable().empty();
+	std::memcpy(header.magic, "ABPT", 4);
+	header.version = treeFileVersion;
+	header.nodeCount = (uint32_t)n;
+	header.flags = names ? treeFileHasNames : 0;
+	header.valuesOffset = align8(sizeof(TreeFileHeader));
+	header.firstChildOffset = align8(header.valuesOffset + n * 4);
+	header.childCountOffset = align8(header.firstChildOffset + n * 4);
+	header.nameOffsetsOffset = names ? align8(header.childCountOffset + n * 4) : 0;
+	header.namesOffset = names ? align8(header.nameOffsetsOffset + n * 4) : 0;
+	header.namesSize = names ? tree.NameTable().size() : 0;
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out)
+		throw std::runtime_error("Cannot create tree file " + path);
+	writeAt(out, 0, &header, sizeof(header));
+	writeAt(out, header.valuesOffset, tree.values.data(), n * 4);
+	writeAt(out, header.firstChildOffset, tree.firstChild.data(), n * 4);
+	writeAt(out, header.childCountOffset, tree.childCount.data(), n * 4);
+	if (names) {
+		// Unnamed nodes at the end have no offset entry, point them at the empty name
+		offsets = tree.NameOffsets();
+		offsets.resize(n, 0);
+		writeAt(out, header.nameOffsetsOffset, offsets.data(), n * 4);
+		writeAt(out, header.namesOffset, tree.NameTable().data(), tree.NameTable().size());
+	}
+	if (!out)
+		throw std::runtime_error("Error writing tree file " + path);
+}
+
+void WriteTreeFile(const std::string& path, const Node* root, bool names) {
+	WriteTreeFile(path, FlatTree(root), names);
+}
+#pragma endregion
+
+#pragma region MappedTree
+MappedTree::MappedTree(const std::string& p, bool scan) : path(p) {
+#ifdef _WIN32
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Cannot open tree file " + path);
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	length = (size_t)size.QuadPart;
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	data = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (data == nullptr) {
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		throw std::runtime_error("Cannot map tree file " + path);
+	}
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		if (fd >= 0)
+			close(fd);
+		throw std::runtime_error("Cannot open tree file " + path);
+	}
+	length = (size_t)st.st_size;
+	data = length > 0 ? mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	close(fd);
+	if (data == MAP_FAILED) {
+		data = nullptr;
+		throw std::runtime_error("Cannot map tree file " + path);
+	}
+#endif
+	try {
+		validate(scan);
+	}
+	catch (...) {
+		unmap();
+		throw;
+	}
+}
+
+MappedTree::~MappedTree() {
+	unmap();
+}
+
+void MappedTree::unmap() {
+	if (data == nullptr)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle(mapping);
+	CloseHandle(file);
+#else
+	munmap(data, length);
+#endif
+	data = nullptr;
+}
+
+// Check the header and that every array lies inside the file. With scan, one pass
+// over the nodes also checks every child range and name offset up front.
+void MappedTree::validate(bool scan) {
+	const char* base = (const char*)data;
+
+	header = (const TreeFileHeader*)base;
+	if (length < sizeof(TreeFileHeader) || std::memcmp(header->magic, "ABPT", 4) != 0)
+		throw std::runtime_error(path + " is not a tree file");
+	if (header->version != treeFileVersion)
+		throw std::runtime_error(path + ": unsupported tree file version " + std::to_string(header->version));
+	if (header->nodeCount == 0)
+		throw std::runtime_error(path + ": empty tree file");
+
+	uint64_t arrayBytes = (uint64_t)header->nodeCount * 4;
+	bool hasNames = (header->flags & treeFileHasNames) != 0;
+	if (!inside(header->valuesOffset, arrayBytes, length) || !inside(header->firstChildOffset, arrayBytes, length) ||
+		!inside(header->childCountOffset, arrayBytes, length) ||
+		(hasNames && (!inside(header->nameOffsetsOffset, arrayBytes, length) || !inside(header->namesOffset, header->namesSize, length))))
+		throw std::runtime_error(path + ": truncated tree file");
+	if (((header->valuesOffset | header->firstChildOffset | header->childCountOffset | header->nameOffsetsOffset) & 3) != 0)
+		throw std::runtime_error(path + ": misaligned tree file arrays");
+	if (hasNames && (header->namesSize == 0 || base[header->namesOffset + header->namesSize - 1] != '\0'))
+		throw std::runtime_error(path + ": unterminated name table");
+
+	values = (const int32_t*)(base + header->valuesOffset);
+	firstChildren = (const uint32_t*)(base + header->firstChildOffset);
+	childCounts = (const uint32_t*)(base + header->childCountOffset);
+	if (hasNames) {
+		nameOffsets = (const uint32_t*)(base + header->nameOffsetsOffset);
+		names = base + header->namesOffset;
+	}
+
+	for (unsigned int n = 0; scan && n < header->nodeCount; n++) {
+		checkChildren(n);
+		Name(n);
+	}
+}
+
+void MappedTree::badNode(unsigned int n, const char* problem) const {
+	throw std::runtime_error(path + ": node " + std::to_string(n) + " " + problem);
+}
+
+// The name table ends with a '\0', so a name starting inside it ends inside it
+const char* MappedTree::Name(unsigned int n) const {
+	if (names == nullptr)
+		return "";
+	if (nameOffsets[n] >= header->namesSize)
+		badNode(n, "has a name outside the name table");
+	return names + nameOffsets[n];
+}
+#pragma endregion
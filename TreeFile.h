@@ -0,0 +1,87 @@
+#pragma once
+/*************************************************************************************/
+// Binary tree file header
+// Layout: header, then 8 byte aligned arrays of node values (int32), first child
+// index and child count (uint32), and optionally name offsets (uint32) and a '\0'
+// separated name table. MappedTree maps a file and serves the arrays straight
+// from the mapped pages, nothing is parsed or allocated per node. Loading checks
+// the header only, a node's child range is checked when the search expands it.
+// Scanning every node at load is an option, it touches every page.
+/*************************************************************************************/
+#include <cstdint>
+#include <string>
+
+#include "AlphaBeta.h"
+#include "FlatTree.h"
+
+struct TreeFileHeader {
+	char magic[4];							// "ABPT"
+	uint32_t version;
+	uint32_t nodeCount;
+	uint32_t flags;							// hasNames
+	uint64_t valuesOffset;
+	uint64_t firstChildOffset;
+	uint64_t childCountOffset;
+	uint64_t nameOffsetsOffset;				// 0 without names
+	uint64_t namesOffset;
+	uint64_t namesSize;
+};
+
+const uint32_t treeFileVersion = 1;
+const uint32_t treeFileHasNames = 1;
+
+void WriteTreeFile(const std::string&, const FlatTree&, bool names = true);
+void WriteTreeFile(const std::string&, const Node*, bool names = true);
+
+class MappedTree {
+public:
+	explicit MappedTree(const std::string&, bool scan = false);
+	~MappedTree();
+	MappedTree(const MappedTree&) = delete;
+	MappedTree& operator=(const MappedTree&) = delete;
+
+	unsigned int size() const { return header->nodeCount; };
+	int value(unsigned int n) const { return values[n]; };
+	unsigned int firstChild(unsigned int n) const { return firstChildren[n]; };
+	unsigned int childCount(unsigned int n) const { return childCounts[n]; };
+	const char* Name(unsigned int) const;
+	// Children come after their parent and end inside the tree
+	void checkChildren(unsigned int n) const {
+		if (childCounts[n] > 0 && (firstChildren[n] <= n || (uint64_t)firstChildren[n] + childCounts[n] > header->nodeCount))
+			badNode(n, "has children outside the tree");
+	};
+private:
+	void* data = nullptr;
+	size_t length = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+	const TreeFileHeader* header = nullptr;
+	const int32_t* values = nullptr;
+	const uint32_t* firstChildren = nullptr;
+	const uint32_t* childCounts = nullptr;
+	const uint32_t* nameOffsets = nullptr;
+	const char* names = nullptr;
+
+	std::string path;
+
+	void validate(bool);
+	void badNode(unsigned int, const char*) const;
+	void unmap();
+};
+
+// SearchCore access policy over a mapped tree, the mapping is read only so
+// backed up values are not stored
+class MappedTreeAccess {
+public:
+	typedef unsigned int Handle;
+	explicit MappedTreeAccess(const MappedTree& t) : tree(t) {};
+	unsigned int expand(Handle n, int) { tree.checkChildren(n); return tree.childCount(n); };
+	Handle enter(Handle n, int, unsigned int i) { return tree.firstChild(n) + i; };
+	void leave(Handle, int, unsigned int) {};
+	int value(Handle n) const { return tree.value(n); };
+	void store(Handle, int) {};
+private:
+	const MappedTree& tree;
+};
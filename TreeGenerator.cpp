@@ -0,0 +1,69 @@
+/*************************************************************************************/
+// Synthetic tree generator
+/*************************************************************************************/
+#include <random>
+#include <stdexcept>
+
+#include "TreeGenerator.h"
+
+#pragma region TreeGenerator
+unsigned long long UniformTreeSize(unsigned int branching, unsigned int depth) {
+	unsigned long long total = 0;
+	unsigned long long level = 1;
+
+	for (unsigned int d = 0; d <= depth; d++) {
+		total += level;
+		level *= branching;
+	}
+	return total;
+}
+
+// Level by level: the best child of a max node copies the parent value and its
+// siblings get lower values, the reverse for a min node. The root is max.
+FlatTree GenerateUniformTree(unsigned int branching, unsigned int depth, TreeOrdering ordering, unsigned int seed) {
+	FlatTree tree;
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> gap(1, 100);
+	std::uniform_int_distribution<unsigned int> position(0, branching > 0 ? branching - 1 : 0);
+	unsigned long long total = UniformTreeSize(branching, depth);
+	unsigned int levelStart = 0;
+	unsigned int levelEnd = 1;
+
+	if (branching == 0 || total >= 0xFFFFFFFFULL)
+		throw std::invalid_argument("Tree size out of range");
+	tree.AddRoot("", 0);
+	tree.reserve((unsigned int)total);
+	for (unsigned int level = 0; level < depth; level++) {
+		bool isMax = (level % 2) == 0;
+		for (unsigned int node = levelStart; node < levelEnd; node++) {
+			unsigned int first = tree.AddChildren(node, branching);
+			unsigned int best = ordering == TreeOrdering::Best ? 0 : (ordering == TreeOrdering::Worst ? branching - 1 : position(rng));
+			int offset = 0;
+			for (unsigned int i = branching; i-- > 0;) {
+				int v = tree.values[node];
+				// Worst case: every child improves on the ones before it, so nothing is cut
+				if (i != best) {
+					offset = ordering == TreeOrdering::Worst ? offset + gap(rng) : gap(rng);
+					v = isMax ? v - offset : v + offset;
+				}
+				tree.SetValue(first + i, v);
+			}
+		}
+		levelStart = levelEnd;
+		levelEnd = tree.size();
+	}
+	tree.Finish();
+	return tree;
+}
+
+std::string OrderingName(TreeOrdering ordering) {
+	switch (ordering) {
+		case TreeOrdering::Best:
+			return "best";
+		case TreeOrdering::Worst:
+			return "worst";
+		default:
+			return "random";
+	}
+}
+#pragma endregion
@@ -0,0 +1,18 @@
+#pragma once
+/*************************************************************************************/
+// Synthetic tree generator header
+// Uniform trees with a given branching factor and depth, built top down so the
+// minimax value of every node is known as it is created. The ordering decides
+// where the best child of each node goes: first (best case for alpha-beta), at a
+// seeded random position, or last with every child improving on the ones before
+// it (near worst case).
+/*************************************************************************************/
+#include <string>
+
+#include "FlatTree.h"
+
+enum class TreeOrdering { Random, Best, Worst };
+
+FlatTree GenerateUniformTree(unsigned int branching, unsigned int depth, TreeOrdering, unsigned int seed);
+unsigned long long UniformTreeSize(unsigned int branching, unsigned int depth);
+std::string OrderingName(TreeOrdering);
@@ -0,0 +1,144 @@
+/*************************************************************************************/
+// Streaming text tree parser
+/*************************************************************************************/
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "TreeParser.h"
+
+namespace {
+	// An integer, min or max
+	int parseValue(const std::string& text, const std::string& source, unsigned long long lineNumber) {
+		if (text == "min")
+			return std::numeric_limits<int>::min();
+		if (text == "max")
+			return std::numeric_limits<int>::max();
+		char* end = nullptr;
+		errno = 0;
+		long long v = std::strtoll(text.c_str(), &end, 10);
+		if (text.empty() || *end != '\0' || errno != 0 || v < std::numeric_limits<int>::min() || v > std::numeric_limits<int>::max())
+			throw TreeParseError(source, lineNumber, "invalid value '" + text + "'");
+		return (int)v;
+	}
+
+	std::string valueText(int value) {
+		if (value == std::numeric_limits<int>::min())
+			return "min";
+		if (value == std::numeric_limits<int>::max())
+			return "max";
+		return std::to_string(value);
+	}
+}
+
+#pragma region TreeParser
+Node* TreeParser::Parse(std::istream& in, const std::string& source) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<Node*> path;							// open nodes, root first
+	Node* root = nullptr;
+	std::string line;
+	unsigned long long lineNumber = 0;
+
+	nodes = 0;
+	alpha = std::numeric_limits<int>::min();
+	beta = std::numeric_limits<int>::max();
+	try {
+		while (std::getline(in, line)) {
+			size_t pos = 0;
+			size_t depth = 0;
+
+			lineNumber++;
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			// Indentation
+			while (pos < line.size() && (line[pos] == '\t' || line[pos] == ' ')) {
+				if (line[pos] == ' ' && (pos + 1 >= line.size() || line[pos + 1] != ' '))
+					throw TreeParseError(source, lineNumber, "indentation must be a tab or two spaces per level");
+				pos += line[pos] == '\t' ? 1 : 2;
+				depth++;
+			}
+			if (depth == 0 && line.compare(0, 8, "#window ") == 0) {
+				std::istringstream window(line.substr(8));
+				std::string a;
+				std::string b;
+				std::string extra;
+				if (!(window >> a >> b) || (window >> extra))
+					throw TreeParseError(source, lineNumber, "expected #window <alpha> <beta>");
+				alpha = parseValue(a, source, lineNumber);
+				beta = parseValue(b, source, lineNumber);
+				continue;
+			}
+			if (pos == line.size() || line[pos] == '#')
+				continue;
+
+			// Name and value
+			size_t nameEnd = line.find_first_of(" \t", pos);
+			if (nameEnd == std::string::npos)
+				throw TreeParseError(source, lineNumber, "missing value");
+			std::string name = line.substr(pos, nameEnd - pos);
+			size_t valueStart = line.find_first_not_of(" \t", nameEnd);
+			if (valueStart == std::string::npos)
+				throw TreeParseError(source, lineNumber, "missing value");
+			std::string text = line.substr(valueStart, line.find_last_not_of(" \t") + 1 - valueStart);
+			int value = parseValue(text, source, lineNumber);
+
+			// Attach to the open node one level up
+			if (depth == 0) {
+				if (root != nullptr)
+					throw TreeParseError(source, lineNumber, "more than one root");
+				root = new Node(name, value);
+				path.push_back(root);
+			}
+			else {
+				if (root == nullptr)
+					throw TreeParseError(source, lineNumber, "indented line before the root");
+				if (depth > path.size())
+					throw TreeParseError(source, lineNumber, "indentation skips a level");
+				path.resize(depth);
+				path.back()->AddChild(name, value);
+				path.push_back(path.back()->children.back());
+			}
+			nodes++;
+		}
+		if (in.bad())
+			throw TreeParseError(source, lineNumber, "read error");
+		if (root == nullptr)
+			throw TreeParseError(source, lineNumber, "no nodes");
+	}
+	catch (...) {
+		delete root;
+		throw;
+	}
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return root;
+}
+
+Node* TreeParser::ParseFile(const std::string& path) {
+	if (path == "-")
+		return Parse(std::cin, "<stdin>");
+	std::ifstream in(path);
+	if (!in)
+		throw std::runtime_error("Cannot open tree file " + path);
+	return Parse(in, path);
+}
+#pragma endregion
+
+#pragma region TextTreeWriter
+namespace {
+	void writeNode(std::ostream& out, const Node* n, unsigned int depth) {
+		out << std::string(depth, '\t') << n->name << ' ' << valueText(n->value) << '\n';
+		for (const Node* c : n->children)
+			writeNode(out, c, depth + 1);
+	}
+}
+
+void WriteTextTree(std::ostream& out, const Node* root, int alpha, int beta) {
+	if (alpha != std::numeric_limits<int>::min() || beta != std::numeric_limits<int>::max())
+		out << "#window " << valueText(alpha) << ' ' << valueText(beta) << '\n';
+	writeNode(out, root, 0);
+}
+#pragma endregion
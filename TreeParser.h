@@ -0,0 +1,46 @@
+#pragma once
+/*************************************************************************************/
+// Streaming text tree parser header
+// One node per line: indentation (a tab or two spaces per level), the node name
+// and its value. A value may be an integer, "min" or "max". Blank lines and lines
+// starting with '#' are skipped, except an unindented "#window <alpha> <beta>",
+// the root window the scenario is searched with, full when there is none. Example:
+//     #window max min
+//     I-II-II max
+//     	0-II-II min
+//     		0-I-II max
+// The stream is read line by line, the parser itself only keeps the path from the
+// root to the current node.
+/*************************************************************************************/
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AlphaBeta.h"
+
+class TreeParseError : public std::runtime_error {
+public:
+	TreeParseError(const std::string& source, unsigned long long line, const std::string& message) :
+		std::runtime_error(source + ":" + std::to_string(line) + ": " + message) {};
+};
+
+class TreeParser {
+public:
+	Node* Parse(std::istream&, const std::string& source = "<stream>");
+	Node* ParseFile(const std::string&);				// "-" reads stdin
+	unsigned long long nodeCount() const { return nodes; };
+	double nodesPerSecond() const { return seconds > 0 ? nodes / seconds : 0.0; };
+	int windowAlpha() const { return alpha; };			// of the last tree parsed
+	int windowBeta() const { return beta; };
+private:
+	unsigned long long nodes = 0;
+	double seconds = 0;
+	int alpha = std::numeric_limits<int>::min();
+	int beta = std::numeric_limits<int>::max();
+};
+
+// The window line is only written when it is not the full window
+void WriteTextTree(std::ostream&, const Node*, int alpha = std::numeric_limits<int>::min(), int beta = std::numeric_limits<int>::max());
@@ -1,13 +1,14 @@
 #pragma once
 /*************************************************************************************/
 // Elapsed Timer class header
+// steady_clock is monotonic, an adjusted wall clock cannot make a duration jump
 /*************************************************************************************/
 #include <chrono>
 #include <ctime>
 
 class ElapsedTimer {
 private:
-	std::chrono::system_clock::time_point start, end;
+	std::chrono::steady_clock::time_point start, end;
 	unsigned long long duration;
 public:
 	ElapsedTimer();
@@ -15,4 +16,4 @@ public:
 	void Stop();
 	unsigned long long DurationNanos();
 	unsigned long long DurationMillis();
-};
\ No newline at end of file
+};
@@ -5,23 +5,22 @@
 
 ElapsedTimer::ElapsedTimer() : duration(0) {}
 void ElapsedTimer::Start() {
-	start = std::chrono::system_clock::now();
+	start = std::chrono::steady_clock::now();
 }
 void ElapsedTimer::Stop() {
-	end = std::chrono::system_clock::now();
+	end = std::chrono::steady_clock::now();
 }
 unsigned long long ElapsedTimer::DurationNanos()
 {
-	// Result in nanoseconds
-	duration = (end - start).count();
+	// Result in nanoseconds, whatever the clock period
+	duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 
 	return duration;
 }
 unsigned long long ElapsedTimer::DurationMillis()
 {
-	// Result in nanoseconds
+	// Result in milliseconds
 	duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-	// Convert to milliseconds
 
 	return duration;
 }
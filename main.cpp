@@ -6,463 +6,898 @@
 //       https://www.cs.cornell.edu/courses/cs312/2002sp/lectures/rec21.htm
 /**************************************************************/
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <limits>
+#include <memory>
+#include <sstream>
+#include <thread>
 #include <vector>
 
 // Local includes
 #include "AlphaBeta.h"
+#include "AsyncSearch.h"
+#include "BatchSearch.h"
+#include "DistributedSearch.h"
+#include "FlatTree.h"
+#include "IterativeDeepening.h"
+#include "LazySMP.h"
+#include "MonteCarloSearch.h"
+#include "MultiPV.h"
+#include "NimState.h"
+#include "NimTablebase.h"
+#include "ParallelAlphaBeta.h"
+#include "PerfCounters.h"
+#include "PhaseTimer.h"
+#include "PVSAlphaBeta.h"
+#include "SearchCore.h"
+#include "SearchSession.h"
 #include "SimpleAlphaBeta.h"
+#include "TreeFile.h"
+#include "TreeParser.h"
+#include "TranspositionTable.h"
 #include "elapseTimer.h"
 
 // Forward Class / Function definitions
-int initTreeTest1(Node*, int, int);
-int initTreeTest2(Node*, int, int);
-int initTreeTest3(Node*, int, int);
-int initTreeTest4(Node*, int, int);
+std::string scenarioPath(int, const std::string&);
+bool usesOptions(const std::string&, const std::vector<std::string>&, const std::vector<std::string>&);
+int searchGame(AlphaBeta&, GameState&, int, const std::string&, int&);
+void printDeepening(const DeepeningResult&, ElapsedTimer&);
+void printOrdering(const MoveOrderer*);
+bool printTablebase(const NimTablebase&, const NimState&, bool, int);
+int searchFile(const std::string&, int, bool);
+int searchBatch(const std::string&, bool, int, unsigned int, const std::string&, bool);
+int searchShared(const Node*, int, int, int, unsigned int);
+int timeScenario(AlphaBeta&, const std::string&, int, int, bool);
+std::string replayVariation(GameState&, const std::vector<Move>&);
+void printMultiPV(const std::vector<RootMove>&);
+int playGame(SearchSession&, int, int);
+void printPlayouts(const AlphaBeta*);
+int searchDistributed(DistributedSearch&, const std::vector<WorkUnit>&, const std::vector<std::string>&, int, int, int, int&);
 
 // Main program
 int main(int argc,char* argv[]) {
 	Node* root = nullptr;
+	FlatTree tree;
 	SimpleAlphaBeta alphaBeta;
 	int min = std::numeric_limits<int>::min();			// minimum value
 	int max = std::numeric_limits<int>::max();
 	int depth = 6;
 	int totalNodes = 0;
 	int abValue = 0;
+	int alpha = min;
+	int beta = max;
 	std::string abName;
 	ElapsedTimer timer;
+	TranspositionTable* table = nullptr;
+	int test = 4;
+	std::string nimPosition;
+	bool misere = false;
+	std::string engineName = "simple";
+	unsigned int threads = std::thread::hardware_concurrency();
+	bool deterministic = false;
+	bool verify = false;
+	std::unique_ptr<AlphaBeta> engineOwner;
+	AlphaBeta* engine = &alphaBeta;
+	long long timeBudget = 0;
+	long long nodeBudget = 0;
+	DeepeningResult deepening;
+	std::unique_ptr<MoveOrderer> orderer;
+	std::string saveFile;
+	std::string loadFile;
+	std::string treeFile;
+	std::string exportFile;
+	std::string batch;
+	bool shared = false;
+	std::string tablebaseFile;
+	bool statistics = false;
+	int repeat = 0;
+	long long cancelAfter = -1;
+	unsigned int multiPV = 0;
+	int playMoves = 0;
+	bool perf = false;
+	bool greedy = false;
+	std::string workerAddress;
+	unsigned int localWorkers = 0;
+	std::string workerList;
+	std::unique_ptr<DistributedSearch> distributed;
+	std::vector<std::string> given;						// every option, for modes that reject the rest
+
+	// Options: -test <n>: search scenarios/test<n>.tree, -table <log2 buckets>, -nim <position> [-misere] [-depth <n>]
+	//          -engine <simple|parallel|pvs|template|lazysmp|mcts> [-threads <n>] [-deterministic] [-verify]
+	//          mcts searches for -time ms (default 1000), at most -nodes playouts, to a horizon of -depth
+	//          plies, -greedy takes game ending wins in its playouts
+	//          -time <ms> and/or -nodes <n>: iterative deepening up to -depth
+	//          -order: killer, history and hash move ordering
+	//          -table is for the simple and lazysmp engines, -order also for pvs, others reject them
+	//          -save <file>: write the scenario tree, -load <file> [-verify]: search a mapped tree file,
+	//          -verify checks every node at load
+	//          -file <file|->: read a text scenario tree, -export <file>: write one
+	//          -batch <position,position,...> [-misere] [-threads <n>]: search Nim positions concurrently,
+	//          -engine parallel splits every query on the batch threads, -verify checks each serially
+	//          -shared [-threads <n>]: read only search of one scenario tree from every thread
+	//          -tablebase <file>: probe a Nim tablebase in the search, with -verify the
+	//          search runs without it and is checked against the table instead
+	//          -stats: per ply counters of the search as JSON lines
+	//          -repeat <n>: build, search and tear down a -test or -file scenario n times, report percentiles
+	//          [-perf]: with hardware counters per phase and per node searched, Linux only
+	//          -cancel <ms>: run the -nim search in the background and cancel it after ms
+	//          -multipv <k>: rank the top k root moves with their variations, simple engine
+	//          -play <n>: play n moves from the -test scenario or -nim position, each search
+	//          reuses the subtree, table and history of the last
+	//          -distribute <n> and/or -workers <address,address,...>: split the root of the -test
+	//          scenario or -nim position over n local worker processes and the listed workers
+	//          -worker <unix:/path|host:port>: serve as a worker for a coordinator
+	for (int i = 1; i < argc; i++) {
+		std::string option = argv[i];
+		given.push_back(option);
+		if (option == "-test" && i + 1 < argc)
+			test = std::stoi(argv[++i]);
+		else if (option == "-table" && i + 1 < argc)
+			table = new TranspositionTable(std::stoi(argv[++i]));
+		else if (option == "-nim" && i + 1 < argc)
+			nimPosition = argv[++i];
+		else if (option == "-misere")
+			misere = true;
+		else if (option == "-depth" && i + 1 < argc)
+			depth = std::stoi(argv[++i]);
+		else if (option == "-engine" && i + 1 < argc)
+			engineName = argv[++i];
+		else if (option == "-threads" && i + 1 < argc)
+			threads = (unsigned int)std::stoi(argv[++i]);
+		else if (option == "-deterministic")
+			deterministic = true;
+		else if (option == "-verify")
+			verify = true;
+		else if (option == "-time" && i + 1 < argc)
+			timeBudget = std::stoll(argv[++i]);
+		else if (option == "-nodes" && i + 1 < argc)
+			nodeBudget = std::stoll(argv[++i]);
+		else if (option == "-order")
+			orderer.reset(new MoveOrderer());
+		else if (option == "-save" && i + 1 < argc)
+			saveFile = argv[++i];
+		else if (option == "-load" && i + 1 < argc)
+			loadFile = argv[++i];
+		else if (option == "-file" && i + 1 < argc)
+			treeFile = argv[++i];
+		else if (option == "-export" && i + 1 < argc)
+			exportFile = argv[++i];
+		else if (option == "-batch" && i + 1 < argc)
+			batch = argv[++i];
+		else if (option == "-shared")
+			shared = true;
+		else if (option == "-tablebase" && i + 1 < argc)
+			tablebaseFile = argv[++i];
+		else if (option == "-stats")
+			statistics = true;
+		else if (option == "-repeat" && i + 1 < argc)
+			repeat = std::stoi(argv[++i]);
+		else if (option == "-cancel" && i + 1 < argc)
+			cancelAfter = std::stoll(argv[++i]);
+		else if (option == "-multipv" && i + 1 < argc)
+			multiPV = (unsigned int)std::stoi(argv[++i]);
+		else if (option == "-play" && i + 1 < argc)
+			playMoves = std::stoi(argv[++i]);
+		else if (option == "-perf")
+			perf = true;
+		else if (option == "-greedy")
+			greedy = true;
+		else if (option == "-worker" && i + 1 < argc)
+			workerAddress = argv[++i];
+		else if (option == "-distribute" && i + 1 < argc)
+			localWorkers = (unsigned int)std::stoi(argv[++i]);
+		else if (option == "-workers" && i + 1 < argc)
+			workerList = argv[++i];
+	}
+
+	if (depth < 1) {
+		std::cerr << "Error: -depth must be at least 1" << std::endl;
+		delete table;
+		return 1;
+	}
+	if (!workerAddress.empty()) {
+		delete table;
+		try {
+			return RunWorker(workerAddress);
+		}
+		catch (const std::exception& e) {
+			std::cerr << "Error: " << e.what() << std::endl;
+			return 1;
+		}
+	}
+	if (localWorkers > 0 || !workerList.empty()) {
+		std::stringstream ss(workerList);
+		std::string address;
+		distributed.reset(new DistributedSearch());
+		try {
+			if (localWorkers > 0) {
+#ifdef __linux__
+				distributed->spawn(localWorkers, "/proc/self/exe");
+#else
+				distributed->spawn(localWorkers, argv[0]);
+#endif
+			}
+			while (std::getline(ss, address, ','))
+				distributed->connect(address);
+		}
+		catch (const std::exception& e) {
+			std::cerr << "Error: " << e.what() << std::endl;
+			delete table;
+			return 1;
+		}
+		std::cout << "Distributed search over " << distributed->workerCount() << " workers" << std::endl;
+	}
 
+	if (engineName == "parallel") {
+		ParallelAlphaBeta* p = new ParallelAlphaBeta(threads);
+		p->setDeterministic(deterministic);
+		engineOwner.reset(p);
+		engine = p;
+		std::cout << "Parallel engine with " << p->threadCount() << " threads" << std::endl;
+	}
+	else if (engineName == "pvs") {
+		engineOwner.reset(new PVSAlphaBeta());
+		engine = engineOwner.get();
+	}
+	else if (engineName == "template") {
+		engineOwner.reset(new TemplateAlphaBeta<>());
+		engine = engineOwner.get();
+	}
+	else if (engineName == "lazysmp") {
+		LazySMPAlphaBeta* l = new LazySMPAlphaBeta(threads);
+		engineOwner.reset(l);
+		engine = l;
+		std::cout << "Lazy SMP engine with " << l->threadCount() << " threads" << std::endl;
+	}
+	else if (engineName == "mcts") {
+		MonteCarloSearch* m = new MonteCarloSearch(threads, timeBudget > 0 ? timeBudget : 1000, nodeBudget);
+		m->setPlayout(greedy ? Playout::Greedy : Playout::Random);
+		engineOwner.reset(m);
+		engine = m;
+		std::cout << "Monte Carlo engine with " << m->threadCount() << " threads, " << (timeBudget > 0 ? timeBudget : 1000) << "ms" << std::endl;
+		timeBudget = 0;						// its own budget, not iterative deepening
+		nodeBudget = 0;
+	}
+	// Only the serial engines take a table, pvs takes move ordering too
+	bool takesTable = engineName == "simple" || engineName == "lazysmp";
+	if ((table != nullptr && !takesTable) || (orderer && !takesTable && engineName != "pvs")) {
+		std::cerr << "Error: the " << engineName << " engine has no " << (table != nullptr && !takesTable ? "table" : "move ordering") << std::endl;
+		delete table;
+		return 1;
+	}
+	engine->setMoveOrderer(orderer.get());
+
+	if (repeat > 0) {
+		engine->setTranspositionTable(table);
+		int result = timeScenario(*engine, treeFile.empty() ? scenarioPath(test, argv[0]) : treeFile, depth, repeat, perf);
+		delete table;
+		return result;
+	}
+
+	if (!batch.empty()) {
+		if (!usesOptions("-batch", given, { "-batch", "-misere", "-depth", "-threads", "-engine", "-verify" })) {
+			delete table;
+			return 1;
+		}
+		int result = searchBatch(batch, misere, depth, threads, engineName, verify);
+		delete table;
+		return result;
+	}
+
+	if (!nimPosition.empty()) {
+		NimState state(nimPosition, misere);
+		std::unique_ptr<NimTablebase> tablebase;
+		int result = 0;
+		int value = 0;
+		if (!tablebaseFile.empty()) {
+			try {
+				tablebase.reset(new NimTablebase(tablebaseFile));
+			}
+			catch (const std::exception& e) {
+				std::cerr << "Error: " << e.what() << std::endl;
+				delete table;
+				return 1;
+			}
+			if (!verify)
+				state.setTablebase(tablebase.get());
+		}
+		engine->setTranspositionTable(table);
+		if (distributed != nullptr) {
+			std::vector<WorkUnit> units = DistributedSearch::splitRoot(state, misere);
+			std::vector<std::string> names;
+			for (const WorkUnit& u : units)
+				names.push_back(u.payload);
+			std::cout << std::endl << "Start distributed " << (misere ? "Misere" : "Normal") << " Nim search from " << state.name() << " to depth " << depth << ": " << std::endl;
+			result = searchDistributed(*distributed, units, names, depth, min, max, value);
+		}
+		else if (playMoves > 0) {
+			SearchSession session(*engine);
+			session.setRoot(state);
+			std::cout << std::endl << "Play " << (misere ? "Misere" : "Normal") << " Nim from " << state.name() << " to depth " << depth << ": " << std::endl;
+			result = playGame(session, depth, playMoves);
+		}
+		else if (multiPV > 0) {
+			alphaBeta.setTranspositionTable(table);
+			alphaBeta.clearSearchCount();
+			std::cout << std::endl << "Top " << multiPV << " moves from " << state.name() << " to depth " << depth << ": " << std::endl;
+			printMultiPV(SearchMultiPV(alphaBeta, state, depth, multiPV));
+			std::cout << std::endl << "Searched " << alphaBeta.searchCount() << " nodes." << std::endl;
+		}
+		else if (cancelAfter >= 0) {
+			timer.Start();
+			SearchHandle handle = SearchAsync(*engine, state, depth, [](const DeepeningResult& r) {
+				std::cout << "\tdepth " << r.depth << ": " << r.value << " " << r.bestMove << ", " << r.nodes << " nodes" << std::endl;
+			}, timeBudget, nodeBudget);
+			if (!handle.waitFor(cancelAfter)) {
+				handle.cancel();
+				std::cout << "\tCancelled after " << cancelAfter << "ms" << std::endl;
+			}
+			deepening = handle.get();
+			timer.Stop();
+			printDeepening(deepening, timer);
+			value = deepening.value;
+		}
+		else if (timeBudget > 0 || nodeBudget > 0) {
+			IterativeDeepening driver(*engine);
+			driver.setBudget(timeBudget, nodeBudget);
+			timer.Start();
+			deepening = driver.search(state, depth);
+			timer.Stop();
+			engine->searchTrace().dump(std::cout);
+			printDeepening(deepening, timer);
+			value = deepening.value;
+		}
+		else {
+			result = searchGame(*engine, state, depth, (misere ? "Misere" : "Normal"), value);
+		}
+		if (tablebase != nullptr)
+			result = printTablebase(*tablebase, state, verify, value) ? result : 1;
+		if (statistics)
+			engine->searchStats().writeJson(std::cout, engineName);
+		printOrdering(orderer.get());
+		delete table;
+		return result;
+	}
+
+
+	if (!loadFile.empty()) {
+		int result = 1;
+		if (!usesOptions("-load", given, { "-load", "-depth", "-verify" })) {
+			delete table;
+			return 1;
+		}
+		try {
+			result = searchFile(loadFile, depth, verify);
+		}
+		catch (const std::exception& e) {
+			std::cerr << "Error: " << e.what() << std::endl;
+		}
+		delete table;
+		return result;
+	}
 
 	std::cout << "Alpha Beta Pruning example!" << std::endl;
 	std::cout << std::endl << "Intialize tree: ";
-	root = new Node("(0)", max, true);
+	if (treeFile.empty())
+		treeFile = scenarioPath(test, argv[0]);
 
-	int test = 4;
 	timer.Start();
-	switch (test) {
-		case 1:
-			//First test
-			totalNodes = initTreeTest1(root, min, max);
-			root->name = "(0)";
-			std::cout << std::endl;
-			std::cout << std::endl << "Start Test 1 with " << totalNodes << " total nodes: " << std::endl;
-			alphaBeta.clearSearchCount();
-			abValue = alphaBeta.search(root, depth, min, max, true);		// standard MinMax
-			break;
-		case 2:
-			// Second test
-			totalNodes = initTreeTest2(root, min, max);
-			std::cout << std::endl;
-			std::cout << std::endl << "Start Test 2 with " << totalNodes << " total nodes: " << std::endl;
-			alphaBeta.clearSearchCount();
-			abValue = alphaBeta.search(root, depth, min, max, true);		// standard MinMax
-			break;
-		case 3:
-			// Misere test
-			totalNodes = initTreeTest3(root, min, max);
-			root->name = "I-II-II";
-			std::cout << std::endl;
-			std::cout << std::endl << "Start Misere Test with " << totalNodes << " total nodes: " << std::endl;
-			alphaBeta.clearSearchCount();
-			abValue = alphaBeta.search(root, depth, max, min, true);			// Misere MinMax
-			break;
-		case 4:
-			// Normal test
-			totalNodes = initTreeTest4(root, min, max);
-			root->name = "I-II-II";
-			std::cout << std::endl;
-			std::cout << std::endl << "Start Normal Test  with " << totalNodes << " total nodes: " << std::endl;
-			alphaBeta.clearSearchCount();
-			abValue = alphaBeta.search(root, depth, min, max, true);		// standard MinMax
-			break;
+	try {
+		TreeParser parser;
+		root = parser.ParseFile(treeFile);
+		totalNodes = (int)parser.nodeCount();
+		alpha = parser.windowAlpha();									// Misere MinMax swaps it
+		beta = parser.windowBeta();
+		std::cout << std::endl << "Parsed " << parser.nodeCount() << " nodes at " << (long long)parser.nodesPerSecond() << " nodes/sec";
+	}
+	catch (const std::exception& e) {
+		std::cerr << std::endl << "Error: " << e.what() << std::endl;
+		delete table;
+		return 1;
+	}
+	std::cout << std::endl;
+	std::cout << std::endl << "Start " << treeFile << " with " << totalNodes << " total nodes: " << std::endl;
+
+	// The Node tree is only a builder for the simple engine, it searches the flat copy
+	tree = FlatTree(root);
+	if (!exportFile.empty()) {
+		std::ofstream out(exportFile);
+		WriteTextTree(out, root, alpha, beta);
+		std::cout << "Exported " << tree.size() << " nodes to " << exportFile << std::endl;
+	}
+	if (!saveFile.empty()) {
+		WriteTreeFile(saveFile, tree);
+		std::cout << "Saved " << tree.size() << " nodes to " << saveFile << std::endl;
+	}
+	if (playMoves > 0) {
+		SearchSession session(*engine);
+		session.setRoot(root);
+		int result = playGame(session, depth, playMoves);
+		delete table;
+		return result;
+	}
+	if (multiPV > 0) {
+		delete root;
+		alphaBeta.setTranspositionTable(table);
+		alphaBeta.clearSearchCount();
+		printMultiPV(SearchMultiPV(alphaBeta, tree, depth, multiPV));
+		std::cout << std::endl << "Searched " << alphaBeta.searchCount() << " nodes." << std::endl;
+		delete table;
+		return 0;
+	}
+	if (distributed != nullptr) {
+		std::vector<std::string> names;
+		for (Node* n : root->children)
+			names.push_back(n->name);
+		int result = searchDistributed(*distributed, DistributedSearch::splitRoot(root), names, depth, alpha, beta, abValue);
+		if (verify) {
+			int referenceValue = alphaBeta.search(tree, 0, depth, alpha, beta, true);
+			std::cout << "Verify: serial " << referenceValue << (referenceValue == abValue ? " matches" : " MISMATCH") << std::endl;
+		}
+		delete root;
+		delete table;
+		return result;
+	}
+	if (shared) {
+		int result = searchShared(root, depth, alpha, beta, threads);
+		delete root;
+		delete table;
+		return result;
+	}
+	engine->setTranspositionTable(table);
+	engine->clearSearchCount();
+	if (timeBudget > 0 || nodeBudget > 0) {
+		IterativeDeepening driver(*engine);
+		driver.setBudget(timeBudget, nodeBudget);
+		deepening = driver.search(root, depth);
+		timer.Stop();
+		engine->searchTrace().dump(std::cout);
+		printDeepening(deepening, timer);
+		printOrdering(orderer.get());
+		if (statistics)
+			engine->searchStats().writeJson(std::cout, engineName);
+		delete root;
+		delete table;
+		return 0;
+	}
+	else if (engine == &alphaBeta) {
+		delete root;
+		root = nullptr;
+		abValue = alphaBeta.search(tree, 0, depth, alpha, beta, true);
+	}
+	else {
+		abValue = engine->search(root, depth, alpha, beta, true);
 	}
 	timer.Stop();
 
 
 	// Print result
+	engine->searchTrace().dump(std::cout);
 	std::cout << "\tResult: " << abValue << std::endl;
-	abName = [root, abValue]() -> std::string {
-		for (Node* n : root->children) {
-			if (n->value == abValue)
-				return n->name;
-		}
-		return "Not found";
+	abName = [root, &tree, &alphaBeta, engine, depth]() -> std::string {
+		// Every engine reports its own choice, the serial ones as their variation
+		if (engine == &alphaBeta)
+			return alphaBeta.flatVariation(depth).empty() ? "Not found" : tree.Name(alphaBeta.flatVariation(depth).front());
+		LazySMPAlphaBeta* lazy = dynamic_cast<LazySMPAlphaBeta*>(engine);
+		if (lazy != nullptr)
+			return lazy->mainSearch().nodeVariation(depth).empty() ? "Not found" : lazy->mainSearch().nodeVariation(depth).front()->name.str();
+		return engine->bestRootIndex() < 0 ? "Not found" : root->children[engine->bestRootIndex()]->name.str();
 	}();			// auto run as closure
 
 	std::cout << "\tResult node: " << abName << std::endl;
-	std::cout << std::endl << "Searched " << alphaBeta.searchCount() << " nodes." << std::endl;
+	if (engine == &alphaBeta && !alphaBeta.flatVariation(depth).empty()) {
+		std::cout << "\tPrincipal variation:";
+		for (unsigned int n : alphaBeta.flatVariation(depth))
+			std::cout << (n == alphaBeta.flatVariation(depth).front() ? " " : " -> ") << tree.Name(n);
+		std::cout << std::endl;
+	}
+	std::cout << std::endl << "Searched " << engine->searchCount() << " nodes." << std::endl;
+	printPlayouts(engine);
+	if (table != nullptr)
+		std::cout << "Table hits: " << engine->hitCount() << ", misses: " << engine->missCount() << std::endl;
+	printOrdering(orderer.get());
 	std::cout << "Duration: " << timer.DurationMillis() << "ms (milliseconds)" << std::endl;
+	if (statistics)
+		engine->searchStats().writeJson(std::cout, engineName);
+
+	// Check against the serial engine on the untouched flat copy
+	if (verify && engine != &alphaBeta) {
+		SimpleAlphaBeta reference;
+		int referenceValue = reference.search(tree, 0, depth, alpha, beta, true);
+		std::cout << "Verify: serial " << referenceValue << (referenceValue == abValue ? " matches" : " MISMATCH") << std::endl;
+	}
 
 	// Cleanup
 	std::cout << std::endl << "Cleanup:" << std::endl;
 	delete root;
+	tree.clear();
+	delete table;
 
 	return 0;
 }
 
-#pragma region Initialization
-// Result is 6 with 
-// cutoff at (4, 3), (4, 10), and (2, 4)
-// Tree from Wikipedia
-int initTreeTest1(Node* n, int min, int max) {
-	Node* node = nullptr;
-	int totalNodes = 0;
+#pragma region GameState
+// Search a position generated on demand, the root moves are tried here so the
+// chosen move can be reported
+int searchGame(AlphaBeta& alphaBeta, GameState& state, int depth, const std::string& label, int& bestValue) {
+	int min = std::numeric_limits<int>::min();
+	int max = std::numeric_limits<int>::max();
+	std::string bestName = "Not found";
+	std::string bestLine;
+	std::vector<Move> moves;
+	ElapsedTimer timer;
+	SimpleAlphaBeta* simple = dynamic_cast<SimpleAlphaBeta*>(&alphaBeta);
+	MonteCarloSearch* monteCarlo = dynamic_cast<MonteCarloSearch*>(&alphaBeta);
 
-	//Create first level as min
-	(*n).AddChild("(1,0)", min).AddChild("(1,1)",min).AddChild("(1,2)", min);
-	totalNodes += 3;
-
-	//Create second level as max
-	node = n->children[0];
-	(*node).AddChild("(2,0)", max).AddChild("(2,1)", max);
-	node = n->children[1];
-	(*node).AddChild("(2,2)",max).AddChild("(2,3)", max);
-	node = n->children[2];
-	(*node).AddChild("(2,4)", max).AddChild("(2.5)", max);
-	totalNodes += 6;
-
-	//Create third level as min
-	node = n->children[0]->children[0];
-	(*node).AddChild("(3,0)", min).AddChild("(3,1)", min);
-	node = n->children[0]->children[1];
-	(*node).AddChild("(3,2)", min);
-	node = n->children[1]->children[0];
-	(*node).AddChild("(3,3)", min).AddChild("(3,4)", min);
-	node = n->children[1]->children[1];
-	(*node).AddChild("(3,5)", min);
-	node = n->children[2]->children[0];
-	(*node).AddChild("(3,6)", min);
-	node = n->children[2]->children[1];
-	(*node).AddChild("(3,7)", min).AddChild("(3,8)", min);
-	totalNodes += 9;
-
-	//Create fourth level with real values
-	node = n->children[0]->children[0]->children[0];
-	(*node).AddChild("(4,0)", 5).AddChild("(4,1)", 6);
-	node = n->children[0]->children[0]->children[1];
-	(*node).AddChild("(4,2)", 7).AddChild("(4,3)", 4).AddChild("(4,4)", 5);
-	node = n->children[0]->children[1]->children[0];
-	(*node).AddChild("(4,5)", 3);
-	node = n->children[1]->children[0]->children[0];
-	(*node).AddChild("(4,6)", 6);
-	node = n->children[1]->children[0]->children[1];
-	(*node).AddChild("(4,7)", 6); node->AddChild("(4,8)", 9);
-	node = n->children[1]->children[1]->children[0];
-	(*node).AddChild("(4,9)", 7);
-	node = n->children[2]->children[0]->children[0];
-	(*node).AddChild("(4,10)", 5);
-	node = n->children[2]->children[1]->children[0];
-	(*node).AddChild("(4,11)", 9); node->AddChild("(4,12)", 8);
-	node = n->children[2]->children[1]->children[1];
-	(*node).AddChild("(4,13)", 6);
-	totalNodes += 14;
-
-	return totalNodes;
+	std::cout << std::endl << "Start " << label << " Nim search from " << state.name() << " to depth " << depth << ": " << std::endl;
+	bestValue = min;
+	alphaBeta.clearSearchCount();
+	timer.Start();
+	state.generateMoves(moves);
+	// Monte Carlo search picks its own root move
+	if (monteCarlo != nullptr && !moves.empty()) {
+		bestValue = monteCarlo->search(state, depth, min, max, true);
+		int index = monteCarlo->bestRootIndex();
+		if (index >= 0) {
+			state.apply(moves[index]);
+			bestName = state.name();
+			state.undo(moves[index]);
+		}
+		moves.clear();
+	}
+	for (Move m : moves) {
+		state.apply(m);
+		int value = alphaBeta.search(state, depth - 1, bestValue, max, false);
+		if (value > bestValue || m == moves.front()) {
+			bestValue = value;
+			bestName = state.name();
+			if (simple != nullptr)
+				bestLine = bestName + replayVariation(state, simple->moveVariation(depth - 1));
+		}
+		state.undo(m);
+	}
+	timer.Stop();
+
+	alphaBeta.searchTrace().dump(std::cout);
+	std::cout << "\tResult: " << bestValue << std::endl;
+	std::cout << "\tResult node: " << bestName << std::endl;
+	if (!bestLine.empty())
+		std::cout << "\tPrincipal variation: " << bestLine << std::endl;
+	std::cout << std::endl << "Searched " << alphaBeta.searchCount() << " nodes." << std::endl;
+	printPlayouts(&alphaBeta);
+	std::cout << "Duration: " << timer.DurationMillis() << "ms (milliseconds)" << std::endl;
+	return 0;
 }
 
-// Result is 4 with 
-// cutoff at (2,3) and (2,5)
-int initTreeTest2(Node* n, int min, int max) {
-	Node* node = nullptr;
-	int totalNodes = 0;
+// Root statistics of a Monte Carlo search, nothing for the other engines
+void printPlayouts(const AlphaBeta* engine) {
+	const MonteCarloSearch* monteCarlo = dynamic_cast<const MonteCarloSearch*>(engine);
 
-	//Create first level as min
-	(*n).AddChild("(1,0)", min).AddChild("(1,1)", min).AddChild("(1,2)", min);
-	totalNodes += 3;
-
-	//Create second level as max
-	node = n->children[0];
-	(*node).AddChild("(2,0)", 4).AddChild("(2,1)", 5);
-	node = n->children[1];
-	(*node).AddChild("(2,2)", 6).AddChild("(2,3)", max).AddChild("(2,4)", max);
-	node = n->children[2];
-	(*node).AddChild("(2,5)", 3).AddChild("(2,6)", 8);
-	totalNodes += 6;
-
-	//Create third level as min
-	node = n->children[1]->children[1];
-	(*node).AddChild("(3,0)", 3).AddChild("(3.1)", 4);
-	node = n->children[1]->children[2];
-	(*node).AddChild("(3,2)", 7).AddChild("(3,3)", 9);
-	totalNodes += 4;
-
-	return totalNodes;
+	if (monteCarlo == nullptr)
+		return;
+	std::cout << "Playouts: " << monteCarlo->playoutCount() << ", tree pool " << monteCarlo->poolBytes() / 1024 << "KB" << std::endl;
+	for (const RootChildStats& c : monteCarlo->rootChildren())
+		std::cout << "\tchild " << c.index << ": " << c.visits << " visits, mean " << c.mean << std::endl;
 }
 
-// Result is 0-II-II (100)
-// Tree for Misere test
-int initTreeTest3(Node* n, int min, int max) {
-	Node* node = nullptr;
-	int totalNodes = 0;
+// Names of the positions along a variation, the state is left as it was
+std::string replayVariation(GameState& state, const std::vector<Move>& line) {
+	std::string names;
 
-	//Create first level as min
-	(*n).AddChild("0-II-II", min).AddChild("I-I-II", min).AddChild("I-0-II", min).AddChild("I-II-I", min).AddChild("I-II-0", min);
-	totalNodes += 5;
-
-	//Create second level as max
-	node = n->children[0];
-	(*node).AddChild("0-I-II", max).AddChild("0-0-II", max).AddChild("0-II-I", max).AddChild("0-II-0", max);
-	node = n->children[1];
-	(*node).AddChild("0-I-II", max).AddChild("I-0-II", max).AddChild("I-I-I", max).AddChild("I-I-0", max);
-	node = n->children[2];
-	(*node).AddChild("0-0-II", max).AddChild("I-0-I", max).AddChild("I-0-0", max);
-	node = n->children[3];
-	(*node).AddChild("0-II-I", max).AddChild("I-I-I", max).AddChild("I-0-I", max).AddChild("I-II-0", max);
-	node = n->children[4];
-	(*node).AddChild("0-II-0", max).AddChild("I-I-0", max).AddChild("I-0-0", max);
-	totalNodes += 18;
-
-	//Create third level as min
-	node = n->children[0]->children[0];
-	(*node).AddChild("0-0-II", min).AddChild("0-I-I", min).AddChild("0-I-0", min);
-	node = n->children[0]->children[1];
-	(*node).AddChild("0-0-I", min).AddChild("0-0-0", 100);
-	node = n->children[0]->children[2];
-	(*node).AddChild("0-I-I", min).AddChild("0-0-I", min).AddChild("0-II-0", min);
-	node = n->children[0]->children[3];
-	(*node).AddChild("0-I-0", min).AddChild("0-0-0", 100);
-	node = n->children[1]->children[0];
-	(*node).AddChild("0-0-II", min).AddChild("0-I-I", min).AddChild("0-I-0", min);
-	node = n->children[1]->children[1];
-	(*node).AddChild("0-0-II", min).AddChild("I-0-I", min).AddChild("I-0-0", min);
-	node = n->children[1]->children[2];
-	(*node).AddChild("0-I-I", min).AddChild("I-0-I", min).AddChild("0-0-I", min);
-	node = n->children[1]->children[3];
-	(*node).AddChild("0-I-0", min).AddChild("I-0-0", min);
-	node = n->children[2]->children[0];
-	(*node).AddChild("0-0-I", min).AddChild("0-0-0", 100);
-	node = n->children[2]->children[1];
-	(*node).AddChild("0-0-I", min).AddChild("I-0-0", min);
-	node = n->children[2]->children[2];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[0];
-	(*node).AddChild("0-I-I", min).AddChild("0-0-I", min).AddChild("0-II-0", min);
-	node = n->children[3]->children[1];
-	(*node).AddChild("0-I-I", min).AddChild("I-0-I", min).AddChild("I-0-0", min);
-	node = n->children[3]->children[2];
-	(*node).AddChild("0-0-I", min).AddChild("I-0-0", min);
-	node = n->children[3]->children[3];
-	(*node).AddChild("0-II-0", min).AddChild("I-I-0", min).AddChild("I-0-0", min);
-	node = n->children[4]->children[0];
-	(*node).AddChild("0-I-0", min).AddChild("0-0-0", 100);
-	node = n->children[4]->children[1];
-	(*node).AddChild("0-I-0", min).AddChild("I-0-0", min);
-	node = n->children[4]->children[2];
-	(*node).AddChild("0-0-0", 100);
-	totalNodes += 3;
-
-	//Create fourth level as max
-	node = n->children[0]->children[0]->children[0];
-	(*node).AddChild("0-0-I", max).AddChild("0-0-0", -100);
-	totalNodes += 2;
-
-	//Create fifth level with real values
-	node = n->children[0]->children[0]->children[0]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	totalNodes += 1;
-
-	return totalNodes;
+	for (Move m : line) {
+		state.apply(m);
+		names += " -> " + state.name();
+	}
+	for (auto m = line.rbegin(); m != line.rend(); ++m)
+		state.undo(*m);
+	return names;
 }
-// Result is 0-II-II (100); 
-// Path is 0-II-II (+) -> 0-I-II (-) -> 0-I-I (+) -> 0-0-I (-) -> 0-0-0 (+) wins 
-// Tree for Normal test
-int initTreeTest4(Node* n, int min, int max) {
-	Node* node = nullptr;
-	int totalNodes = 0;
 
-	//Create first level as min
-	(*n).AddChild("0-II-II", min).AddChild("I-I-II", min).AddChild("I-0-II", min).AddChild("I-II-I", min).AddChild("I-II-0", min);
-	totalNodes += 5;
-
-	//Create second level as max
-	node = n->children[0];
-	(*node).AddChild("0-I-II", max).AddChild("0-0-II", max).AddChild("0-II-I", max).AddChild("0-II-0", max);
-	node = n->children[1];
-	(*node).AddChild("0-I-II", max).AddChild("I-0-II", max).AddChild("I-I-I", max).AddChild("I-I-0", max);
-	node = n->children[2];
-	(*node).AddChild("0-0-II", max).AddChild("I-0-I", max).AddChild("I-0-0", max);
-	node = n->children[3];
-	(*node).AddChild("I-II-0", max).AddChild("0-II-I", max).AddChild("I-I-I", max).AddChild("I-0-I", max);
-	node = n->children[4];
-	(*node).AddChild("0-II-0", max).AddChild("I-I-0", max).AddChild("I-0-0", max);
-	totalNodes += 18;
-
-	//Create third level as min
-	node = n->children[0]->children[0];
-	(*node).AddChild("0-0-II", min).AddChild("0-I-I", min).AddChild("0-I-0", min);
-	node = n->children[0]->children[1];
-	(*node).AddChild("0-0-I", min).AddChild("0-0-0", 100);
-	node = n->children[0]->children[2];
-	(*node).AddChild("0-I-I", min).AddChild("0-0-I", min).AddChild("0-II-0", min);
-	node = n->children[0]->children[3];
-	(*node).AddChild("0-I-0", min).AddChild("0-0-0", 100);
-	node = n->children[1]->children[0];
-	(*node).AddChild("0-0-II", min).AddChild("0-I-I", min).AddChild("0-I-0", min);
-	node = n->children[1]->children[1];
-	(*node).AddChild("0-0-II", min).AddChild("I-0-I", min).AddChild("I-0-0", min);
-	node = n->children[1]->children[2];
-	(*node).AddChild("0-I-I", min).AddChild("I-0-I", min).AddChild("I-I-0", min);
-	node = n->children[1]->children[3];
-	(*node).AddChild("0-I-0", min).AddChild("0-0-I", min);
-	node = n->children[2]->children[0];
-	(*node).AddChild("0-0-I", min).AddChild("0-0-0", 100);
-	node = n->children[2]->children[1];
-	(*node).AddChild("0-0-I", min).AddChild("I-0-0", min);
-	node = n->children[2]->children[2];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[0];
-	(*node).AddChild("0-II-0", min).AddChild("I-I-0", min).AddChild("I-0-0", min);
-	node = n->children[3]->children[1];
-	(*node).AddChild("0-II-0", min).AddChild("0-I-I", min).AddChild("0-0-I", min);
-	node = n->children[3]->children[2];
-	(*node).AddChild("0-I-I", min).AddChild("I-0-I", min).AddChild("I-I-0", min);
-	node = n->children[3]->children[3];
-	(*node).AddChild("0-0-I", min).AddChild("I-0-0", min);
-	node = n->children[4]->children[0];
-	(*node).AddChild("0-I-0", min).AddChild("0-0-0", 100);
-	node = n->children[4]->children[1];
-	(*node).AddChild("0-I-0", min).AddChild("I-0-0", min);
-	node = n->children[4]->children[2];
-	(*node).AddChild("0-0-0", 100);
-	totalNodes += 42;
-
-	//Create fourth level as max
-	node = n->children[0]->children[0]->children[0];
-	(*node).AddChild("0-0-I", max).AddChild("0-0-0", -100);
-	node = n->children[0]->children[0]->children[1];
-	(*node).AddChild("0-0-I", max).AddChild("0-I-0", max);
-	node = n->children[0]->children[0]->children[2];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[0]->children[1]->children[0];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[0]->children[2]->children[0];
-	(*node).AddChild("0-0-I", max).AddChild("0-0-0", -100);
-	node = n->children[0]->children[2]->children[1];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[0]->children[2]->children[2];
-	(*node).AddChild("0-I-0", max).AddChild("0-0-0", -100);
-	node = n->children[0]->children[3]->children[0];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[1]->children[0]->children[0];
-	(*node).AddChild("0-0-I", max).AddChild("0-0-0", -100);
-	node = n->children[1]->children[0]->children[1];
-	(*node).AddChild("0-0-I", max).AddChild("0-I-0", max);
-	node = n->children[1]->children[0]->children[2];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[1]->children[1]->children[0];
-	(*node).AddChild("0-0-0", -100).AddChild("0-0-I", max);
-	node = n->children[1]->children[1]->children[1];
-	(*node).AddChild("0-0-I", max).AddChild("I-0-0", max);
-	node = n->children[1]->children[1]->children[2];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[1]->children[2]->children[0];
-	(*node).AddChild("0-0-I", max).AddChild("0-I-0", max);
-	node = n->children[1]->children[2]->children[1];
-	(*node).AddChild("I-0-0", max).AddChild("0-0-I", max);
-	node = n->children[1]->children[2]->children[2];
-	(*node).AddChild("0-I-0", max).AddChild("0-0-0", -100);
-	node = n->children[1]->children[3]->children[0];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[1]->children[3]->children[1];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[2]->children[0]->children[0];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[2]->children[1]->children[0];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[2]->children[1]->children[1];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[3]->children[0]->children[0];
-	(*node).AddChild("0-0-I", max).AddChild("0-0-0", -100);
-	node = n->children[3]->children[0]->children[1];
-	(*node).AddChild("0-I-0", max).AddChild("I-0-0", max);
-	node = n->children[3]->children[0]->children[2];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[3]->children[1]->children[0];
-	(*node).AddChild("0-0-0", -100).AddChild("0-I-0", max);
-	node = n->children[3]->children[1]->children[1];
-	(*node).AddChild("0-0-I", max).AddChild("0-I-0", max);
-	node = n->children[3]->children[1]->children[2];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[3]->children[2]->children[0];
-	(*node).AddChild("0-0-I", max).AddChild("0-I-0", max);
-	node = n->children[3]->children[2]->children[1];
-	(*node).AddChild("I-0-0", max).AddChild("0-0-I", max);
-	node = n->children[3]->children[2]->children[2];
-	(*node).AddChild("0-I-0", max).AddChild("0-0-0", -100);
-	node = n->children[3]->children[3]->children[0];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[3]->children[3]->children[1];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[4]->children[0]->children[0];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[4]->children[1]->children[0];
-	(*node).AddChild("0-0-0", -100);
-	node = n->children[4]->children[1]->children[1];
-	(*node).AddChild("0-0-0", -100);
-
-	totalNodes += 57;
-
-	//Create fifth level with leaf values
-	node = n->children[0]->children[0]->children[0]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[0]->children[0]->children[1]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[0]->children[0]->children[1]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[0]->children[2]->children[0]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[0]->children[2]->children[0]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[0]->children[2]->children[2]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[0]->children[0]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[0]->children[1]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[0]->children[1]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[1]->children[0]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[1]->children[1]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[1]->children[1]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[2]->children[0]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[2]->children[0]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[2]->children[1]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[2]->children[1]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[1]->children[2]->children[2]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[0]->children[0]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[0]->children[1]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[0]->children[1]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[1]->children[0]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[1]->children[1]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[1]->children[1]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[2]->children[0]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[2]->children[0]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[2]->children[1]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[2]->children[1]->children[1];
-	(*node).AddChild("0-0-0", 100);
-	node = n->children[3]->children[2]->children[2]->children[0];
-	(*node).AddChild("0-0-0", 100);
-	totalNodes += 28;
-
-	return totalNodes;
+// Each decision searches from the child the last one played
+int playGame(SearchSession& session, int depth, int moves) {
+	ElapsedTimer timer;
+
+	for (int m = 1; m <= moves; m++) {
+		timer.Start();
+		SearchResult result = session.search(depth);
+		timer.Stop();
+		if (result.bestIndex < 0) {
+			std::cout << "\tNo moves from " << session.rootName() << std::endl;
+			break;
+		}
+		std::cout << "\tMove " << m << ": " << (session.rootIsMax() ? "max" : "min") << " plays " << session.childName(result.bestIndex)
+			<< ", value " << result.value << ", " << result.nodes << " nodes in " << timer.DurationNanos() / 1000 << "us" << std::endl;
+		session.advance(result.bestIndex);
+	}
+	return 0;
+}
+
+void printMultiPV(const std::vector<RootMove>& top) {
+	for (unsigned int i = 0; i < top.size(); i++) {
+		std::cout << "\t" << i + 1 << ". " << top[i].value << ":";
+		for (unsigned int n = 0; n < top[i].line.size(); n++)
+			std::cout << (n == 0 ? " " : " -> ") << top[i].line[n];
+		std::cout << std::endl;
+	}
+}
+
+void printDeepening(const DeepeningResult& result, ElapsedTimer& timer) {
+	std::cout << "\tResult: " << result.value << " at depth " << result.depth << std::endl;
+	std::cout << "\tResult node: " << result.bestMove << std::endl;
+	std::cout << "\tAspiration re-searches: " << result.researches << std::endl;
+	std::cout << std::endl << "Searched " << result.nodes << " nodes." << std::endl;
+	std::cout << "Duration: " << timer.DurationMillis() << "ms (milliseconds)" << std::endl;
+}
+
+// Ground truth for the root, the searched value must agree unless the search was
+// too shallow to reach the end of the game
+bool printTablebase(const NimTablebase& tablebase, const NimState& state, bool verify, int value) {
+	NimState probed(state);
+	int exact = 0;
+
+	probed.setTablebase(&tablebase);
+	if (!probed.probe(exact)) {
+		std::cout << "Tablebase: " << state.name() << " is not in the table" << std::endl;
+		return true;
+	}
+	std::cout << "Tablebase: " << exact << std::endl;
+	if (verify)
+		std::cout << "Verify: tablebase " << exact << (exact == value ? " matches" : " MISMATCH") << std::endl;
+	return !verify || exact == value;
+}
+
+void printOrdering(const MoveOrderer* orderer) {
+	if (orderer == nullptr)
+		return;
+	std::cout << "Cutoffs: " << orderer->cutoffCount() << ", on first move: " << orderer->firstMoveCutoffCount()
+		<< " (" << (int)(orderer->firstMoveCutoffRate() * 100) << "%)" << std::endl;
+}
+#pragma endregion
+
+#pragma region TreeFile
+// Search a tree file in place, the root is a max node. With verify every node is
+// checked at load, otherwise only the nodes the search expands.
+int searchFile(const std::string& path, int depth, bool verify) {
+	int min = std::numeric_limits<int>::min();
+	int max = std::numeric_limits<int>::max();
+	std::string bestName = "Not found";
+	ElapsedTimer loadTimer, timer;
+
+	loadTimer.Start();
+	MappedTree tree(path, verify);
+	loadTimer.Stop();
+	std::cout << "Mapped " << tree.size() << " nodes from " << path << " in " << loadTimer.DurationMillis() << "ms" << std::endl;
+
+	MappedTreeAccess access(tree);
+	timer.Start();
+	SearchResult result = SearchRoot(access, 0, depth, min, max, true);
+	timer.Stop();
+	if (result.bestIndex >= 0)
+		bestName = tree.Name(tree.firstChild(0) + result.bestIndex);
+
+	std::cout << "\tResult: " << result.value << std::endl;
+	std::cout << "\tResult node: " << bestName << std::endl;
+	std::cout << std::endl << "Searched " << result.nodes << " nodes." << std::endl;
+	std::cout << "Duration: " << timer.DurationMillis() << "ms (milliseconds)" << std::endl;
+	return 0;
+}
+#pragma endregion
+
+#pragma region Batch
+// Every position is a separate query, results come back in the order given
+int searchBatch(const std::string& list, bool misere, int depth, unsigned int threads, const std::string& engineName, bool verify) {
+	std::vector<std::unique_ptr<NimState>> states;
+	std::vector<SearchQuery> queries;
+	std::stringstream ss(list);
+	std::string position;
+	ElapsedTimer timer;
+
+	try {
+		while (std::getline(ss, position, ','))
+			states.emplace_back(new NimState(position, misere));
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+	for (std::unique_ptr<NimState>& s : states) {
+		SearchQuery q;
+		q.state = s.get();
+		q.depth = depth;
+		queries.push_back(q);
+	}
+
+	ThreadPool pool(threads);
+	BatchSearch::EngineFactory factory = []() { return std::unique_ptr<AlphaBeta>(new SimpleAlphaBeta()); };
+	if (engineName == "parallel")
+		factory = [&pool]() { return std::unique_ptr<AlphaBeta>(new ParallelAlphaBeta(pool)); };	// splits on the batch pool
+	else if (engineName != "simple") {
+		std::cerr << "Error: -batch runs the simple or parallel engine" << std::endl;
+		return 1;
+	}
+	BatchSearch batch(pool, factory);
+	std::cout << "Batch of " << queries.size() << " positions with the " << engineName << " engine on " << pool.size() << " threads" << std::endl;
+	timer.Start();
+	std::vector<QueryResult> results = batch.search(queries);
+	timer.Stop();
+
+	int mismatches = 0;
+	for (size_t i = 0; i < results.size(); i++) {
+		if (results[i].error != nullptr) {
+			try {
+				std::rethrow_exception(results[i].error);
+			}
+			catch (const std::exception& e) {
+				std::cout << "\t" << states[i]->name() << ": Error: " << e.what() << std::endl;
+			}
+			catch (...) {
+				std::cout << "\t" << states[i]->name() << ": Error" << std::endl;
+			}
+			mismatches++;
+			continue;
+		}
+		std::cout << "\t" << states[i]->name() << ": " << results[i].value << " (" << results[i].nodes << " nodes)";
+		if (verify) {
+			SimpleAlphaBeta reference;
+			NimState state(states[i]->name(), misere);
+			int referenceValue = reference.search(state, depth, queries[i].alpha, queries[i].beta, true);
+			mismatches += referenceValue == results[i].value ? 0 : 1;
+			std::cout << ", serial " << referenceValue << (referenceValue == results[i].value ? " matches" : " MISMATCH");
+		}
+		std::cout << std::endl;
+	}
+	std::cout << "Duration: " << timer.DurationMillis() << "ms (milliseconds)" << std::endl;
+	return mismatches == 0 ? 0 : 1;
+}
+#pragma endregion
+
+#pragma region Options
+// A mode reports every option given that it would ignore
+bool usesOptions(const std::string& mode, const std::vector<std::string>& given, const std::vector<std::string>& used) {
+	bool all = true;
+
+	for (const std::string& option : given) {
+		if (std::find(used.begin(), used.end(), option) == used.end()) {
+			std::cerr << "Error: " << mode << " does not use " << option << std::endl;
+			all = false;
+		}
+	}
+	return all;
+}
+#pragma endregion
+
+#pragma region Scenarios
+// The -test scenarios ship next to the sources, a build run from elsewhere
+// finds them beside the executable
+std::string scenarioPath(int test, const std::string& program) {
+	std::string name = "scenarios/test" + std::to_string(test) + ".tree";
+	if (std::ifstream(name).good())
+		return name;
+	size_t slash = program.find_last_of("/\\");
+	if (slash == std::string::npos)
+		return name;
+	std::string beside = program.substr(0, slash + 1) + name;
+	return std::ifstream(beside).good() ? beside : name;
+}
+#pragma endregion
+
+#pragma region Distributed
+// The root is a max node, names are the root children in unit order
+int searchDistributed(DistributedSearch& search, const std::vector<WorkUnit>& units, const std::vector<std::string>& names,
+	int depth, int alpha, int beta, int& value) {
+	ElapsedTimer timer;
+	DistributedResult result;
+
+	timer.Start();
+	try {
+		result = search.search(units, depth, alpha, beta, true);
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+	timer.Stop();
+	value = result.value;
+
+	std::cout << "\tResult: " << result.value << std::endl;
+	std::cout << "\tResult node: " << (result.bestIndex >= 0 ? names[result.bestIndex] : "Not found") << std::endl;
+	std::cout << std::endl << "Searched " << result.nodes << " nodes in " << result.completed << " units, " << result.cancelled << " cancelled." << std::endl;
+	std::cout << "Duration: " << timer.DurationMillis() << "ms (milliseconds)" << std::endl;
+	return 0;
+}
+#pragma endregion
+
+#pragma region Shared
+// Every thread searches the same tree at once, the tree is never written so
+// no locking is needed and all of them must agree
+int searchShared(const Node* root, int depth, int alpha, int beta, unsigned int threads) {
+	std::vector<SearchResult> results(threads > 0 ? threads : 1);
+	std::vector<std::thread> workers;
+	ElapsedTimer timer;
+	bool agree = true;
+
+	timer.Start();
+	for (size_t i = 0; i < results.size(); i++) {
+		workers.emplace_back([root, depth, alpha, beta, &results, i]() {
+			ConstNodeTreeAccess access;
+			results[i] = SearchRoot(access, root, depth, alpha, beta, true);
+		});
+	}
+	for (std::thread& t : workers)
+		t.join();
+	timer.Stop();
+
+	for (const SearchResult& r : results)
+		agree = agree && r.value == results[0].value && r.bestIndex == results[0].bestIndex;
+	std::cout << "\tResult: " << results[0].value << std::endl;
+	std::cout << "\tResult node: " << (results[0].bestIndex >= 0 ? root->children[results[0].bestIndex]->name.str() : std::string("Not found")) << std::endl;
+	std::cout << std::endl << "Searched " << results[0].nodes << " nodes on each of " << results.size() << " threads, "
+		<< (agree ? "all agree" : "MISMATCH") << std::endl;
+	std::cout << "Duration: " << timer.DurationMillis() << "ms (milliseconds)" << std::endl;
+	return agree ? 0 : 1;
+}
+#pragma endregion
+
+#pragma region Timing
+// Every phase of a scenario is sampled on each repetition, the tree is rebuilt
+// so the search never sees values written by the previous one. With hardware
+// counters the repetitions run twice, timed and then counted, so neither
+// measurement includes reading the other.
+int timeScenario(AlphaBeta& engine, const std::string& path, int depth, int repeat, bool perf) {
+	PhaseTimer phases;
+	std::unique_ptr<PerfCounters> counters(perf ? new PerfCounters() : nullptr);
+	TreeParser parser;
+	int value = 0;
+
+	// The file is read once, each build parses it from memory
+	std::ifstream in(path);
+	if (!in) {
+		std::cerr << "Error: cannot open " << path << std::endl;
+		return 1;
+	}
+	std::stringstream text;
+	text << in.rdbuf();
+	try {
+		int passes = counters != nullptr && counters->Available() ? 2 : 1;
+		for (int pass = 0; pass < passes; pass++) {
+			auto measure = [&](const char* phase, auto work) {
+				if (pass == 1) {
+					PerfCounters::Scope scope(*counters, phase);
+					work();
+				}
+				else {
+					PhaseTimer::Scope scope(phases, phase);
+					work();
+				}
+			};
+			for (int r = 0; r < repeat; r++) {
+				Node* root = nullptr;
+				measure("build", [&]() {
+					std::istringstream scenario(text.str());
+					root = parser.Parse(scenario, path);
+				});
+				measure("search", [&]() {
+					engine.clearSearchCount();
+					value = engine.search(root, depth, parser.windowAlpha(), parser.windowBeta(), true);
+				});
+				measure("teardown", [&]() { delete root; });
+			}
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+
+	std::cout << path << " result " << value << ", " << engine.searchCount() << " nodes per search" << std::endl;
+	phases.WriteReport(std::cout);
+	phases.WriteJson(std::cout);
+	if (counters != nullptr && !counters->Available())
+		std::cout << "Hardware counters unavailable: " << counters->Error() << std::endl;
+	else if (counters != nullptr)
+		counters->WriteJson(std::cout, engine.searchCount());
+	return 0;
 }
-#pragma endregion
\ No newline at end of file
+#pragma endregion